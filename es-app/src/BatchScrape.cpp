@@ -0,0 +1,211 @@
+#include "BatchScrape.h"
+#include "scrapers/ScraperBatch.h"
+#include "FileData.h"
+#include "Gamelist.h"
+#include "Log.h"
+#include "PlatformId.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include <SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+namespace
+{
+	const int PROGRESS_INTERVAL_MS = 2000;
+
+	typedef std::chrono::steady_clock Clock;
+
+	double secondsSince(const Clock::time_point& start)
+	{
+		return std::chrono::duration_cast< std::chrono::duration<double> >(Clock::now() - start).count();
+	}
+
+	// the same defaults as the scraper menu: every system with a platform
+	bool getSystems(std::vector<SystemData*>& systems)
+	{
+		const std::string& names = Settings::getInstance()->getString("ScrapeSystems");
+		if(names.empty())
+		{
+			for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
+			{
+				if(!(*it)->getPlatformIds().empty() && !(*it)->hasPlatformId(PlatformIds::PLATFORM_IGNORE))
+					systems.push_back(*it);
+			}
+
+			return true;
+		}
+
+		std::istringstream stream(names);
+		std::string name;
+		while(std::getline(stream, name, ','))
+		{
+			auto it = std::find_if(SystemData::sSystemVector.cbegin(), SystemData::sSystemVector.cend(),
+				[&name](SystemData* system) { return system->getName() == name; });
+
+			if(it == SystemData::sSystemVector.cend())
+			{
+				std::cerr << "Unknown system \"" << name << "\", or it has no games.\n";
+				return false;
+			}
+
+			systems.push_back(*it);
+		}
+
+		return true;
+	}
+
+	std::queue<ScraperSearchParams> getSearches(const std::vector<SystemData*>& systems, bool onlyMissingImage)
+	{
+		std::queue<ScraperSearchParams> queue;
+		for(auto sys = systems.cbegin(); sys != systems.cend(); sys++)
+		{
+			std::vector<FileData*> games = (*sys)->getRootFolder()->getFilesRecursive(GAME);
+			for(auto game = games.cbegin(); game != games.cend(); game++)
+			{
+				if(onlyMissingImage && !(*game)->metadata.get("image").empty())
+					continue;
+
+				ScraperSearchParams search;
+				search.game = *game;
+				search.system = *sys;
+
+				queue.push(search);
+			}
+		}
+
+		return queue;
+	}
+}
+
+int runBatchScrape()
+{
+	const std::string& filter = Settings::getInstance()->getString("ScrapeFilter");
+	if(filter != "all" && filter != "missing")
+	{
+		std::cerr << "Invalid scrape filter \"" << filter << "\", use \"all\" or \"missing\".\n";
+		return 1;
+	}
+
+	// --scraper, --scrape-searches and --scrape-downloads only apply to this run, they aren't saved over the menu's settings
+	std::string scraper = Settings::getInstance()->getString("ScrapeScraper");
+	if(scraper.empty())
+		scraper = Settings::getInstance()->getString("Scraper");
+	int maxSearches = Settings::getInstance()->getInt("ScrapeMaxSearches");
+	if(maxSearches <= 0)
+		maxSearches = Settings::getInstance()->getInt("ScraperMaxSearches");
+	int maxDownloads = Settings::getInstance()->getInt("ScrapeMaxDownloads");
+	if(maxDownloads <= 0)
+		maxDownloads = Settings::getInstance()->getInt("ScraperMaxDownloads");
+
+	const std::vector<std::string> scrapers = getScraperList();
+	if(std::find(scrapers.cbegin(), scrapers.cend(), scraper) == scrapers.cend())
+	{
+		std::cerr << "Unknown scraper \"" << scraper << "\".\n";
+		return 1;
+	}
+
+	// no video, but finished requests still wake us up through the event queue, and Ctrl+C arrives as SDL_QUIT
+	if(SDL_InitSubSystem(SDL_INIT_EVENTS) != 0)
+	{
+		std::cerr << "Could not initialize SDL events: " << SDL_GetError() << "\n";
+		return 1;
+	}
+
+	const Clock::time_point loadStart = Clock::now();
+	if(!SystemData::loadConfig() || SystemData::sSystemVector.empty())
+	{
+		std::cerr << "No systems loaded, check " << SystemData::getConfigPath(false) << " and the log.\n";
+		SDL_QuitSubSystem(SDL_INIT_EVENTS);
+		return 1;
+	}
+
+	std::vector<SystemData*> systems;
+	if(!getSystems(systems))
+	{
+		SystemData::deleteSystems();
+		SDL_QuitSubSystem(SDL_INIT_EVENTS);
+		return 1;
+	}
+
+	std::queue<ScraperSearchParams> searches = getSearches(systems, filter == "missing");
+	const size_t total = searches.size();
+
+	std::cout << "Loaded " << SystemData::sSystemVector.size() << " systems in " << std::fixed << std::setprecision(1) <<
+		secondsSince(loadStart) << "s. Scraping " << total << " games from " << systems.size() << " systems with " <<
+		scraper << ", " << maxSearches << " searches and " << maxDownloads << " downloads at once.\n" << std::flush;
+
+	size_t scraped = 0;
+	size_t skipped = 0;
+	std::set<SystemData*> changedSystems;
+
+	const Clock::time_point start = Clock::now();
+	bool interrupted = false;
+	{
+		ScraperBatch batch(searches, scraper, maxSearches, maxDownloads);
+		batch.setAcceptCallback([&](const ScraperSearchParams& search, const ScraperSearchResult& result)
+		{
+			search.game->metadata = result.mdl;
+			changedSystems.insert(search.system);
+			scraped++;
+		});
+		batch.setSkipCallback([&](const ScraperSearchParams& search)
+		{
+			LOG(LogInfo) << "No result for \"" << search.game->getPath().string() << "\"";
+			skipped++;
+		});
+
+		Clock::time_point nextProgress = start + std::chrono::milliseconds(PROGRESS_INTERVAL_MS);
+		while(!batch.isDone())
+		{
+			batch.update();
+
+			const Clock::time_point now = Clock::now();
+			if(now >= nextProgress)
+			{
+				const double elapsed = secondsSince(start);
+				const size_t done = scraped + skipped;
+				const double perSecond = done / elapsed;
+
+				std::cout << "[" << done << "/" << total << "] " << scraped << " scraped, " << skipped << " skipped, " <<
+					std::setprecision(1) << perSecond << " games/s";
+				if(perSecond > 0)
+					std::cout << ", " << (int)((total - done) / perSecond) << "s left";
+				std::cout << "\n" << std::flush;
+
+				nextProgress = now + std::chrono::milliseconds(PROGRESS_INTERVAL_MS);
+			}
+
+			Log::flush();
+
+			// sleep until a request finishes (or a rate limited one is due to start)
+			SDL_Event event;
+			if(SDL_WaitEventTimeout(&event, 100) && event.type == SDL_QUIT)
+			{
+				interrupted = true;
+				break;
+			}
+		}
+		// anything still in flight is dropped with the batch
+	}
+
+	const double elapsed = secondsSince(start);
+
+	if(interrupted)
+		std::cout << "Interrupted, saving what was scraped so far.\n";
+
+	for(auto it = changedSystems.cbegin(); it != changedSystems.cend(); it++)
+		updateGamelist(*it);
+
+	std::cout << scraped << " games scraped, " << skipped << " skipped in " << std::setprecision(1) << elapsed << "s (" <<
+		(elapsed > 0 ? (scraped + skipped) / elapsed : 0) << " games/s). Gamelists written for " << changedSystems.size() <<
+		" systems.\n" << std::flush;
+
+	SystemData::deleteSystems();
+	SDL_QuitSubSystem(SDL_INIT_EVENTS);
+	return interrupted ? 1 : 0;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#ifndef ES_APP_BATCH_SCRAPE_H
+#define ES_APP_BATCH_SCRAPE_H
+
+// Scrapes without a window (--scrape): loads the systems, scrapes every game that passes Settings "ScrapeFilter" ("all", or
+// "missing" for games without an image) in Settings "ScrapeSystems" (comma separated names, every system with a platform if
+// empty) with the configured scraper, always taking the first result, and writes the gamelists once it's done.
+// Settings "ScrapeScraper", "ScrapeMaxSearches" and "ScrapeMaxDownloads" replace the menu's scraper settings for the run if set.
+// Progress goes to stdout. Ctrl+C stops early, keeping what was scraped so far.
+// Returns the process exit code.
+int runBatchScrape();
+
+#endif // ES_APP_BATCH_SCRAPE_H
@@ -6,7 +6,7 @@
 namespace fs = boost::filesystem;
 
 FileData::FileData(FileType type, const fs::path& path, SystemData* system)
-	: mType(type), mPath(path), mSystem(system), mParent(NULL), metadata(type == GAME ? GAME_METADATA : FOLDER_METADATA) // metadata is REALLY set in the constructor!
+	: mType(type), mPath(path), mSystem(system), mParent(NULL), metadata(type == GAME ? GAME_METADATA : FOLDER_METADATA), mGameCount(0), mFolderCount(0) // metadata is REALLY set in the constructor!
 {
 	// metadata needs at least a name field (since that's what getName() will return)
 	if(metadata.get("name").empty())
@@ -63,6 +63,11 @@ const std::string FileData::getThumbnailPath() const
 	return thumbnail;
 }
 
+bool FileData::hasArtwork() const
+{
+	return !metadata.get("thumbnail").empty() || !metadata.get("image").empty();
+}
+
 const std::string FileData::getImagePath() const
 {
 	std::string image = metadata.get("image");
@@ -88,20 +93,30 @@ const std::string FileData::getImagePath() const
 std::vector<FileData*> FileData::getFilesRecursive(unsigned int typeMask) const
 {
 	std::vector<FileData*> out;
+	out.reserve((typeMask & GAME ? mGameCount : 0) + (typeMask & FOLDER ? mFolderCount : 0));
+	getFilesRecursive(typeMask, out);
+	return out;
+}
 
+void FileData::getFilesRecursive(unsigned int typeMask, std::vector<FileData*>& out) const
+{
 	for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
 	{
 		if((*it)->getType() & typeMask)
 			out.push_back(*it);
 
 		if((*it)->getChildren().size() > 0)
-		{
-			std::vector<FileData*> subchildren = (*it)->getFilesRecursive(typeMask);
-			out.insert(out.cend(), subchildren.cbegin(), subchildren.cend());
-		}
+			(*it)->getFilesRecursive(typeMask, out);
 	}
+}
 
-	return out;
+void FileData::updateCounts(int games, int folders)
+{
+	for(FileData* folder = this; folder != NULL; folder = folder->mParent)
+	{
+		folder->mGameCount += games;
+		folder->mFolderCount += folders;
+	}
 }
 
 void FileData::addChild(FileData* file)
@@ -115,6 +130,9 @@ void FileData::addChild(FileData* file)
 		mChildrenByFilename[key] = file;
 		mChildren.push_back(file);
 		file->mParent = this;
+
+		// the new child can be a folder that already has children of its own
+		updateCounts(file->mGameCount + (file->mType == GAME ? 1 : 0), file->mFolderCount + (file->mType == FOLDER ? 1 : 0));
 	}
 }
 
@@ -128,6 +146,7 @@ void FileData::removeChild(FileData* file)
 		if(*it == file)
 		{
 			mChildren.erase(it);
+			updateCounts(-(int)(file->mGameCount + (file->mType == GAME ? 1 : 0)), -(int)(file->mFolderCount + (file->mType == FOLDER ? 1 : 0)));
 			return;
 		}
 	}
@@ -45,9 +45,14 @@ public:
 
 	virtual const std::string getThumbnailPath() const;
 	virtual const std::string getImagePath() const;
+	bool hasArtwork() const; // thumbnail or image metadata is set, without looking for local images like getThumbnailPath()
 
 	std::vector<FileData*> getFilesRecursive(unsigned int typeMask) const;
 
+	// Number of games/folders anywhere below this folder, kept up to date by addChild() and removeChild().
+	inline unsigned int getGameCount() const { return mGameCount; }
+	inline unsigned int getFolderCount() const { return mFolderCount; }
+
 	void addChild(FileData* file); // Error if mType != FOLDER
 	void removeChild(FileData* file); //Error if mType != FOLDER
 
@@ -74,12 +79,17 @@ public:
 	MetaDataList metadata;
 
 private:
+	void getFilesRecursive(unsigned int typeMask, std::vector<FileData*>& out) const;
+	void updateCounts(int games, int folders); // adds to this folder's counts and all of its parents'
+
 	FileType mType;
 	boost::filesystem::path mPath;
 	SystemData* mSystem;
 	FileData* mParent;
 	std::unordered_map<std::string,FileData*> mChildrenByFilename;
 	std::vector<FileData*> mChildren;
+	unsigned int mGameCount;
+	unsigned int mFolderCount;
 };
 
 #endif // ES_APP_FILE_DATA_H
@@ -81,9 +81,8 @@ FileData* findOrCreateFile(SystemData* system, const boost::filesystem::path& pa
 	return NULL;
 }
 
-void parseGamelist(SystemData* system)
+void parseGamelist(SystemData* system, bool trustGamelist)
 {
-	bool trustGamelist = Settings::getInstance()->getBool("ParseGamelistOnly");
 	std::string xmlpath = system->getGamelistPath(false);
 
 	if(!boost::filesystem::exists(xmlpath))
@@ -141,6 +140,9 @@ void parseGamelist(SystemData* system)
 				file->metadata.set("name", defaultName);
 
 			file->metadata.resetChangedFlag();
+
+			if(file->hasArtwork())
+				system->setHasArtwork();
 		}
 	}
 }
@@ -4,8 +4,8 @@
 
 class SystemData;
 
-// Loads gamelist.xml data into a SystemData.
-void parseGamelist(SystemData* system);
+// Loads gamelist.xml data into a SystemData. With trustGamelist (Settings "ParseGamelistOnly") files aren't checked for on disk.
+void parseGamelist(SystemData* system, bool trustGamelist);
 
 // Writes currently loaded metadata for a SystemData to gamelist.xml.
 void updateGamelist(SystemData* system);
@@ -12,15 +12,51 @@
 #include <iostream>
 #include "Settings.h"
 #include "FileSorts.h"
+#include "BootReport.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <future>
 
 std::vector<SystemData*> SystemData::sSystemVector;
 
 namespace fs = boost::filesystem;
 
+// a system as listed in es_systems.cfg, waiting to be loaded
+struct SystemDecl
+{
+	std::string name;
+	std::string fullName;
+	std::string path;
+	std::vector<std::string> extensions;
+	std::string command;
+	std::vector<PlatformIds::PlatformId> platformIds;
+	std::string themeFolder;
+};
+
+// state of the background system loader started by loadConfigAsync()
+static std::thread sLoadThread;
+static std::mutex sLoadMutex; // guards sLoadedSystems
+static std::vector<SystemData*> sLoadedSystems; // finished, but not collected by the main thread yet
+static std::atomic<bool> sLoadRunning(false);
+static std::atomic<bool> sLoadCancel(false);
+static std::atomic<unsigned int> sLoadDone(0);
+static unsigned int sLoadTotal = 0;
+
+// the settings the loader threads need, read before they start since the menus can change them while they run
+struct LoadOptions
+{
+	bool parseGamelistOnly;
+	bool ignoreGamelist;
+	std::string themeSetPath;
+};
+
 SystemData::SystemData(const std::string& name, const std::string& fullName, const std::string& startPath, const std::vector<std::string>& extensions,
-	const std::string& command, const std::vector<PlatformIds::PlatformId>& platformIds, const std::string& themeFolder)
+	const std::string& command, const std::vector<PlatformIds::PlatformId>& platformIds, const std::string& themeFolder,
+	bool parseGamelistOnly, bool ignoreGamelist, const std::shared_ptr<ThemeData>& theme)
 {
 	mName = name;
+	mHasArtwork = false;
 	mFullName = fullName;
 	mStartPath = startPath;
 
@@ -39,15 +75,30 @@ SystemData::SystemData(const std::string& name, const std::string& fullName, con
 	mRootFolder = new FileData(FOLDER, mStartPath, this);
 	mRootFolder->metadata.set("name", mFullName);
 
-	if(!Settings::getInstance()->getBool("ParseGamelistOnly"))
+	if(!parseGamelistOnly)
+	{
+		BootReport::Phase phase("scan", mName);
 		populateFolder(mRootFolder);
+	}
 
-	if(!Settings::getInstance()->getBool("IgnoreGamelist"))
-		parseGamelist(this);
+	if(!ignoreGamelist)
+	{
+		BootReport::Phase phase("gamelist", mName);
+		parseGamelist(this, parseGamelistOnly);
+	}
 
-	mRootFolder->sort(FileSorts::SortTypes.at(0));
+	{
+		BootReport::Phase phase("sort", mName);
+		mRootFolder->sort(FileSorts::SortTypes.at(0));
+	}
 
-	loadTheme();
+	if(theme)
+	{
+		mTheme = theme;
+	}else{
+		BootReport::Phase phase("theme", mName);
+		loadTheme();
+	}
 }
 
 SystemData::~SystemData()
@@ -195,24 +246,26 @@ std::vector<std::string> readList(const std::string& str, const char* delims = "
 	return ret;
 }
 
-//creates systems from information located in a config file
-bool SystemData::loadConfig()
+//reads the list of systems from the config file, without loading any of them
+static bool parseConfig(std::vector<SystemDecl>& systems)
 {
-	deleteSystems();
-
-	std::string path = getConfigPath(false);
+	std::string path = SystemData::getConfigPath(false);
 
 	LOG(LogInfo) << "Loading system config file " << path << "...";
 
 	if(!fs::exists(path))
 	{
 		LOG(LogError) << "es_systems.cfg file does not exist!";
-		writeExampleConfig(getConfigPath(true));
+		SystemData::writeExampleConfig(SystemData::getConfigPath(true));
 		return false;
 	}
 
 	pugi::xml_document doc;
-	pugi::xml_parse_result res = doc.load_file(path.c_str());
+	pugi::xml_parse_result res;
+	{
+		BootReport::Phase phase("es_systems.cfg");
+		res = doc.load_file(path.c_str());
+	}
 
 	if(!res)
 	{
@@ -232,25 +285,24 @@ bool SystemData::loadConfig()
 
 	for(pugi::xml_node system = systemList.child("system"); system; system = system.next_sibling("system"))
 	{
-		std::string name, fullname, path, cmd, themeFolder;
+		SystemDecl decl;
 
-		name = system.child("name").text().get();
-		fullname = system.child("fullname").text().get();
-		path = system.child("path").text().get();
+		decl.name = system.child("name").text().get();
+		decl.fullName = system.child("fullname").text().get();
+		decl.path = system.child("path").text().get();
 
 		// if kiosk mode, hide non system platforms, like retropie-setup
-		if(Settings::getInstance()->getBool("ForceKiosk") && !isGameSystem(name))
+		if(Settings::getInstance()->getBool("ForceKiosk") && !SystemData::isGameSystem(decl.name))
 			continue;
 
 		// convert extensions list from a string into a vector of strings
-		std::vector<std::string> extensions = readList(system.child("extension").text().get());
+		decl.extensions = readList(system.child("extension").text().get());
 
-		cmd = system.child("command").text().get();
+		decl.command = system.child("command").text().get();
 
 		// platform id list
 		const char* platformList = system.child("platform").text().get();
 		std::vector<std::string> platformStrs = readList(platformList);
-		std::vector<PlatformIds::PlatformId> platformIds;
 		for(auto it = platformStrs.cbegin(); it != platformStrs.cend(); it++)
 		{
 			const char* str = it->c_str();
@@ -259,45 +311,194 @@ bool SystemData::loadConfig()
 			if(platformId == PlatformIds::PLATFORM_IGNORE)
 			{
 				// when platform is ignore, do not allow other platforms
-				platformIds.clear();
-				platformIds.push_back(platformId);
+				decl.platformIds.clear();
+				decl.platformIds.push_back(platformId);
 				break;
 			}
 
 			// if there appears to be an actual platform ID supplied but it didn't match the list, warn
 			if(str != NULL && str[0] != '\0' && platformId == PlatformIds::PLATFORM_UNKNOWN)
-				LOG(LogWarning) << "  Unknown platform for system \"" << name << "\" (platform \"" << str << "\" from list \"" << platformList << "\")";
+				LOG(LogWarning) << "  Unknown platform for system \"" << decl.name << "\" (platform \"" << str << "\" from list \"" << platformList << "\")";
 			else if(platformId != PlatformIds::PLATFORM_UNKNOWN)
-				platformIds.push_back(platformId);
+				decl.platformIds.push_back(platformId);
 		}
 
 		// theme folder
-		themeFolder = system.child("theme").text().as_string(name.c_str());
+		decl.themeFolder = system.child("theme").text().as_string(decl.name.c_str());
 
 		//validate
-		if(name.empty() || path.empty() || extensions.empty() || cmd.empty())
+		if(decl.name.empty() || decl.path.empty() || decl.extensions.empty() || decl.command.empty())
 		{
-			LOG(LogError) << "System \"" << name << "\" is missing name, path, extension, or command!";
+			LOG(LogError) << "System \"" << decl.name << "\" is missing name, path, extension, or command!";
 			continue;
 		}
 
+		//expand home symbol here too, the themes are looked up before the system is created
+		if(decl.path[0] == '~')
+		{
+			decl.path.erase(0, 1);
+			decl.path.insert(0, getHomePath());
+		}
+
 		//convert path to generic directory seperators
-		boost::filesystem::path genericPath(path);
-		path = genericPath.generic_string();
+		boost::filesystem::path genericPath(decl.path);
+		decl.path = genericPath.generic_string();
+
+		systems.push_back(decl);
+	}
+
+	return true;
+}
+
+//parses the themes of all systems on a few threads, so the loader only has to wait for a theme if it scans faster than they're parsed
+class ThemeLoader
+{
+public:
+	ThemeLoader(const std::vector<SystemDecl>& systems, const std::string& themeSetPath) : mSystems(systems), mThemeSetPath(themeSetPath), mNext(0), mThemes(systems.size()), mErrors(systems.size()), mPromises(systems.size())
+	{
+		for(unsigned int i = 0; i < systems.size(); i++)
+			mFutures.push_back(mPromises[i].get_future());
+
+		const unsigned int threadCount = std::max(1u, std::min(std::thread::hardware_concurrency(), (unsigned int)systems.size()));
+		for(unsigned int i = 0; i < threadCount; i++)
+			mThreads.push_back(std::thread(&ThemeLoader::run, this));
+	}
+
+	~ThemeLoader()
+	{
+		for(auto it = mThreads.begin(); it != mThreads.end(); it++)
+			it->join();
+	}
+
+	// blocks until the theme for systems[index] is parsed, error is set if it failed to load
+	std::shared_ptr<ThemeData> get(unsigned int index, std::string* error)
+	{
+		mFutures[index].wait();
+		*error = mErrors[index];
+		return mThemes[index];
+	}
+
+private:
+	void run()
+	{
+		for(unsigned int i = mNext++; i < mSystems.size(); i = mNext++)
+		{
+			// still resolve every promise when cancelled, an empty theme is never used
+			if(!sLoadCancel)
+			{
+				const SystemDecl& decl = mSystems[i];
+				BootReport::Phase phase("theme", decl.name);
+				mThemes[i] = SystemData::createTheme(decl.name, decl.fullName, decl.path, decl.themeFolder, mThemeSetPath, &mErrors[i]);
+			}
+
+			mPromises[i].set_value();
+		}
+	}
+
+	const std::vector<SystemDecl>& mSystems;
+	const std::string& mThemeSetPath;
+	std::atomic<unsigned int> mNext;
+	std::vector<std::shared_ptr<ThemeData>> mThemes;
+	std::vector<std::string> mErrors; // per system, empty if the theme loaded fine
+	std::vector<std::promise<void>> mPromises;
+	std::vector<std::future<void>> mFutures;
+	std::vector<std::thread> mThreads;
+};
+
+//scans and parses the given systems one after another while their themes load in parallel, runs on sLoadThread
+static void loadSystems(std::vector<SystemDecl> systems, LoadOptions options)
+{
+	ThemeLoader themes(systems, options.themeSetPath);
 
-		SystemData* newSys = new SystemData(name, fullname, path, extensions, cmd, platformIds, themeFolder);
+	for(unsigned int i = 0; i < systems.size() && !sLoadCancel; i++)
+	{
+		const SystemDecl& decl = systems[i];
+
+		std::string themeError;
+		std::shared_ptr<ThemeData> theme = themes.get(i, &themeError);
+		if(!themeError.empty())
+			LOG(LogError) << "Could not load the theme for system \"" << decl.name << "\":\n" << themeError;
+
+		SystemData* newSys = new SystemData(decl.name, decl.fullName, decl.path, decl.extensions, decl.command, decl.platformIds, decl.themeFolder,
+			options.parseGamelistOnly, options.ignoreGamelist, theme);
 		if(newSys->getRootFolder()->getChildrenByFilename().size() == 0)
 		{
-			LOG(LogWarning) << "System \"" << name << "\" has no games! Ignoring it.";
+			LOG(LogWarning) << "System \"" << decl.name << "\" has no games! Ignoring it.";
 			delete newSys;
 		}else{
-			sSystemVector.push_back(newSys);
+			std::unique_lock<std::mutex> lock(sLoadMutex);
+			sLoadedSystems.push_back(newSys);
 		}
+
+		sLoadDone++;
 	}
 
+	sLoadRunning = false;
+}
+
+//creates systems from information located in a config file
+bool SystemData::loadConfig()
+{
+	if(!loadConfigAsync())
+		return false;
+
+	sLoadThread.join();
+	collectLoadedSystems();
+	return true;
+}
+
+bool SystemData::loadConfigAsync()
+{
+	deleteSystems();
+
+	std::vector<SystemDecl> systems;
+	if(!parseConfig(systems))
+		return false;
+
+	LoadOptions options;
+	options.parseGamelistOnly = Settings::getInstance()->getBool("ParseGamelistOnly");
+	options.ignoreGamelist = Settings::getInstance()->getBool("IgnoreGamelist");
+	options.themeSetPath = ThemeData::getCurrentThemeSetPath().generic_string(); // falling back to another set changes a setting
+
+	sLoadCancel = false;
+	sLoadDone = 0;
+	sLoadTotal = (unsigned int)systems.size();
+	sLoadRunning = true;
+	sLoadThread = std::thread(loadSystems, systems, options);
 	return true;
 }
 
+bool SystemData::isLoading()
+{
+	if(sLoadRunning)
+		return true;
+
+	std::unique_lock<std::mutex> lock(sLoadMutex);
+	return !sLoadedSystems.empty();
+}
+
+void SystemData::getLoadProgress(unsigned int* loaded, unsigned int* total)
+{
+	*loaded = sLoadDone;
+	*total = sLoadTotal;
+}
+
+std::vector<SystemData*> SystemData::collectLoadedSystems()
+{
+	std::vector<SystemData*> systems;
+	{
+		std::unique_lock<std::mutex> lock(sLoadMutex);
+		systems.swap(sLoadedSystems);
+	}
+
+	sSystemVector.insert(sSystemVector.end(), systems.cbegin(), systems.cend());
+
+	if(!sLoadRunning && sLoadThread.joinable())
+		sLoadThread.join();
+
+	return systems;
+}
+
 void SystemData::writeExampleConfig(const std::string& path)
 {
 	std::ofstream file(path.c_str());
@@ -346,6 +547,14 @@ void SystemData::writeExampleConfig(const std::string& path)
 
 void SystemData::deleteSystems()
 {
+	// stop the loader after the system it's working on, anything it already finished is deleted with the rest
+	if(sLoadThread.joinable())
+	{
+		sLoadCancel = true;
+		sLoadThread.join();
+	}
+	collectLoadedSystems();
+
 	for(unsigned int i = 0; i < sSystemVector.size(); i++)
 	{
 		delete sSystemVector.at(i);
@@ -380,6 +589,11 @@ std::string SystemData::getGamelistPath(bool forWrite) const
 }
 
 std::string SystemData::getThemePath() const
+{
+	return getThemePath(mStartPath, mThemeFolder, ThemeData::getCurrentThemeSetPath().generic_string());
+}
+
+std::string SystemData::getThemePath(const std::string& startPath, const std::string& themeFolder, const std::string& themeSetPath)
 {
 	// where we check for themes, in order:
 	// 1. [SYSTEM_PATH]/theme.xml
@@ -387,12 +601,12 @@ std::string SystemData::getThemePath() const
 	// 3. default system theme from currently selected theme set [CURRENT_THEME_PATH]/theme.xml
 
 	// first, check game folder
-	fs::path localThemePath = mRootFolder->getPath() / "theme.xml";
+	fs::path localThemePath = fs::path(startPath) / "theme.xml";
 	if(fs::exists(localThemePath))
 		return localThemePath.generic_string();
 
 	// not in game folder, try system theme in theme sets
-	localThemePath = ThemeData::getThemeFromCurrentSet(mThemeFolder);
+	localThemePath = themeSetPath.empty() ? fs::path() : fs::path(themeSetPath) / themeFolder / "theme.xml";
 
 	if (fs::exists(localThemePath))
 		return localThemePath.generic_string();
@@ -415,30 +629,42 @@ bool SystemData::isGameSystem() const
 
 unsigned int SystemData::getGameCount() const
 {
-	return mRootFolder->getFilesRecursive(GAME).size();
+	return mRootFolder->getGameCount();
 }
 
 void SystemData::loadTheme()
 {
-	mTheme = std::make_shared<ThemeData>();
+	std::string error;
+	mTheme = createTheme(mName, mFullName, mStartPath, mThemeFolder, ThemeData::getCurrentThemeSetPath().generic_string(), &error);
 
-	std::string path = getThemePath();
+	if(!error.empty())
+		LOG(LogError) << error;
+}
+
+std::shared_ptr<ThemeData> SystemData::createTheme(const std::string& name, const std::string& fullName, const std::string& startPath,
+	const std::string& themeFolder, const std::string& themeSetPath, std::string* error)
+{
+	std::shared_ptr<ThemeData> theme = std::make_shared<ThemeData>();
+
+	std::string path = getThemePath(startPath, themeFolder, themeSetPath);
 
 	if(!fs::exists(path)) // no theme available for this platform
-		return;
+		return theme;
 
 	try
 	{
 		// build map with system variables for theme to use,
 		std::map<std::string, std::string> sysData;
-		sysData.insert(std::pair<std::string, std::string>("system.name", getName()));
-		sysData.insert(std::pair<std::string, std::string>("system.theme", getThemeFolder()));
-		sysData.insert(std::pair<std::string, std::string>("system.fullName", getFullName()));
+		sysData.insert(std::pair<std::string, std::string>("system.name", name));
+		sysData.insert(std::pair<std::string, std::string>("system.theme", themeFolder));
+		sysData.insert(std::pair<std::string, std::string>("system.fullName", fullName));
 
-		mTheme->loadFile(sysData, path);
+		theme->loadFile(sysData, path);
 	} catch(ThemeException& e)
 	{
-		LOG(LogError) << e.what();
-		mTheme = std::make_shared<ThemeData>(); // reset to empty
+		*error = e.what();
+		theme = std::make_shared<ThemeData>(); // reset to empty
 	}
+
+	return theme;
 }
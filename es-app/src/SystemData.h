@@ -14,8 +14,12 @@
 class SystemData
 {
 public:
+	// theme is loaded from the theme set if not given
+	// parseGamelistOnly and ignoreGamelist are Settings "ParseGamelistOnly" and "IgnoreGamelist", passed in so they're read
+	// on the main thread only
 	SystemData(const std::string& name, const std::string& fullName, const std::string& startPath, const std::vector<std::string>& extensions,
-		const std::string& command, const std::vector<PlatformIds::PlatformId>& platformIds, const std::string& themeFolder);
+		const std::string& command, const std::vector<PlatformIds::PlatformId>& platformIds, const std::string& themeFolder,
+		bool parseGamelistOnly, bool ignoreGamelist, const std::shared_ptr<ThemeData>& theme = nullptr);
 	~SystemData();
 
 	inline FileData* getRootFolder() const { return mRootFolder; };
@@ -38,10 +42,22 @@ public:
 
 	unsigned int getGameCount() const;
 
+	// True once any file in this system has a thumbnail or image set, which makes its gamelist view a detailed one.
+	// Never reset, so a view won't go back to being basic until the systems are reloaded.
+	inline bool hasArtwork() const { return mHasArtwork; }
+	inline void setHasArtwork() { mHasArtwork = true; }
+
 	void launchGame(Window* window, FileData* game);
 
 	static void deleteSystems();
 	static bool loadConfig(); //Load the system config file at getConfigPath(). Returns true if no errors were encountered. An example will be written if the file doesn't exist.
+
+	// Like loadConfig(), but only parses the config file before returning. The systems themselves are then
+	// loaded one by one on a background thread and become available through collectLoadedSystems().
+	static bool loadConfigAsync();
+	static bool isLoading(); // true until every system has been loaded and collected
+	static void getLoadProgress(unsigned int* loaded, unsigned int* total); // loaded includes systems that were ignored for having no games
+	static std::vector<SystemData*> collectLoadedSystems(); // moves systems that finished loading into sSystemVector and returns them, main thread only
 	static void writeExampleConfig(const std::string& path);
 	static std::string getConfigPath(bool forWrite); // if forWrite, will only return ~/.emulationstation/es_systems.cfg, never /etc/emulationstation/es_systems.cfg
 
@@ -69,6 +85,13 @@ public:
 	// Load or re-load theme.
 	void loadTheme();
 
+	// Loads a system's theme without needing the system itself from themeSetPath, which ThemeData::getCurrentThemeSetPath()
+	// resolves on the main thread, so it's safe to call from any thread.
+	// Returns an empty theme and sets error if the theme could not be loaded.
+	static std::shared_ptr<ThemeData> createTheme(const std::string& name, const std::string& fullName, const std::string& startPath,
+		const std::string& themeFolder, const std::string& themeSetPath, std::string* error);
+	static std::string getThemePath(const std::string& startPath, const std::string& themeFolder, const std::string& themeSetPath);
+
 private:
 	std::string mName;
 	std::string mFullName;
@@ -78,6 +101,7 @@ private:
 	std::vector<PlatformIds::PlatformId> mPlatformIds;
 	std::string mThemeFolder;
 	std::shared_ptr<ThemeData> mTheme;
+	bool mHasArtwork;
 
 	void populateFolder(FileData* folder);
 
@@ -0,0 +1,165 @@
+#include "bench/SyntheticRomTree.h"
+#include <fstream>
+#include <sstream>
+#include <SDL.h>
+#include <FreeImage.h>
+#include <pugixml.hpp>
+#include "Log.h"
+
+namespace fs = boost::filesystem;
+
+static const char* BENCH_DESCRIPTION_TEXT = "A fearless hero sets out across seven worlds to rescue the kingdom from an ancient evil. "
+	"Explore sprawling dungeons, solve devious puzzles and collect over forty power-ups. "
+	"Features two-player simultaneous play, a password save system and a secret final stage. ";
+
+static bool writeInputConfig(const fs::path& path)
+{
+	struct { const char* name; int key; } keys[] = {
+		{ "up", SDLK_UP }, { "down", SDLK_DOWN }, { "left", SDLK_LEFT }, { "right", SDLK_RIGHT },
+		{ "a", SDLK_RETURN }, { "b", SDLK_ESCAPE }, { "start", SDLK_F1 }, { "select", SDLK_F2 },
+		{ "pageup", SDLK_RIGHTBRACKET }, { "pagedown", SDLK_LEFTBRACKET }
+	};
+
+	pugi::xml_document doc;
+	pugi::xml_node cfg = doc.append_child("inputList").append_child("inputConfig");
+	cfg.append_attribute("type") = "keyboard";
+	cfg.append_attribute("deviceName") = "Keyboard";
+	cfg.append_attribute("deviceGUID") = "-1";
+
+	for(unsigned int i = 0; i < sizeof(keys) / sizeof(keys[0]); i++)
+	{
+		pugi::xml_node input = cfg.append_child("input");
+		input.append_attribute("name") = keys[i].name;
+		input.append_attribute("type") = "key";
+		input.append_attribute("id").set_value(keys[i].key);
+		input.append_attribute("value").set_value(1);
+	}
+
+	return doc.save_file(path.string().c_str());
+}
+
+static bool writeArtwork(const fs::path& path, unsigned int width, unsigned int height)
+{
+	FIBITMAP* bitmap = FreeImage_Allocate(width, height, 24);
+	if(bitmap == NULL)
+		return false;
+
+	// a gradient compresses about as badly as real boxart does
+	for(unsigned int y = 0; y < height; y++)
+	{
+		BYTE* line = FreeImage_GetScanLine(bitmap, y);
+		for(unsigned int x = 0; x < width; x++)
+		{
+			line[x * 3 + 0] = (BYTE)(x * 255 / width);
+			line[x * 3 + 1] = (BYTE)(y * 255 / height);
+			line[x * 3 + 2] = (BYTE)((x ^ y) & 0xFF);
+		}
+	}
+
+	bool ok = FreeImage_Save(FIF_PNG, bitmap, path.string().c_str()) != 0;
+	FreeImage_Unload(bitmap);
+	return ok;
+}
+
+static std::string makeDescription(unsigned int length)
+{
+	std::string desc;
+	while(desc.length() < length)
+		desc += BENCH_DESCRIPTION_TEXT;
+
+	return desc.substr(0, length);
+}
+
+bool createSyntheticRomTree(const fs::path& root, const SyntheticRomTreeParams& params)
+{
+	const fs::path configDir = root / ".emulationstation";
+	const fs::path romDir = root / "roms";
+	fs::create_directories(configDir);
+	fs::create_directories(romDir);
+
+	if(!writeInputConfig(configDir / "es_input.cfg"))
+	{
+		LOG(LogError) << "Could not write bench input config to " << configDir;
+		return false;
+	}
+
+	// one encoded image is copied for every game so each one still loads its own file
+	const fs::path artTemplate = root / "art.png";
+	const bool hasArt = params.artWidth > 0 && params.artHeight > 0;
+	if(hasArt && !writeArtwork(artTemplate, params.artWidth, params.artHeight))
+	{
+		LOG(LogError) << "Could not write bench artwork to " << artTemplate;
+		return false;
+	}
+
+	const std::string description = makeDescription(params.descriptionLength);
+
+	pugi::xml_document systemsDoc;
+	pugi::xml_node systemList = systemsDoc.append_child("systemList");
+
+	for(unsigned int s = 0; s < params.systems; s++)
+	{
+		const std::string name = "bench" + std::to_string(s);
+		const fs::path systemDir = romDir / name;
+		fs::create_directories(systemDir);
+
+		pugi::xml_node system = systemList.append_child("system");
+		system.append_child("name").text().set(name.c_str());
+		system.append_child("fullname").text().set(("Benchmark System " + std::to_string(s)).c_str());
+		system.append_child("path").text().set(systemDir.generic_string().c_str());
+		system.append_child("extension").text().set(".rom");
+		system.append_child("command").text().set("true");
+
+		pugi::xml_document gamelistDoc;
+		pugi::xml_node gameList = gamelistDoc.append_child("gameList");
+
+		for(unsigned int g = 0; g < params.gamesPerSystem; g++)
+		{
+			// spread games over the folder levels, with a handful of sibling folders per level
+			fs::path gameDir = systemDir;
+			for(unsigned int d = 0; d < g % (params.folderDepth + 1); d++)
+				gameDir /= "folder" + std::to_string(d) + "_" + std::to_string((g / 100) % 8);
+			fs::create_directories(gameDir);
+
+			// names start with every letter so jump-to-letter has somewhere to go
+			std::stringstream ss;
+			ss << (char)('A' + g % 26) << " Game " << g;
+			const std::string gameName = ss.str();
+
+			const fs::path romPath = gameDir / (gameName + ".rom");
+			std::ofstream(romPath.string().c_str()).close();
+
+			pugi::xml_node game = gameList.append_child("game");
+			game.append_child("path").text().set(romPath.generic_string().c_str());
+			game.append_child("name").text().set(gameName.c_str());
+			game.append_child("desc").text().set(description.c_str());
+			game.append_child("developer").text().set("Bench Software");
+			game.append_child("genre").text().set("Action");
+			game.append_child("rating").text().set("0.8");
+
+			if(hasArt)
+			{
+				const fs::path artPath = systemDir / "images" / (gameName + ".png");
+				fs::create_directories(artPath.parent_path());
+				fs::copy_file(artTemplate, artPath, fs::copy_option::overwrite_if_exists);
+				game.append_child("image").text().set(artPath.generic_string().c_str());
+			}
+		}
+
+		const fs::path gamelistPath = configDir / "gamelists" / name / "gamelist.xml";
+		fs::create_directories(gamelistPath.parent_path());
+		if(!gamelistDoc.save_file(gamelistPath.string().c_str()))
+		{
+			LOG(LogError) << "Could not write bench gamelist " << gamelistPath;
+			return false;
+		}
+	}
+
+	if(!systemsDoc.save_file((configDir / "es_systems.cfg").string().c_str()))
+	{
+		LOG(LogError) << "Could not write bench es_systems.cfg to " << configDir;
+		return false;
+	}
+
+	return true;
+}
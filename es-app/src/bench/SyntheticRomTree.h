@@ -0,0 +1,26 @@
+#pragma once
+#ifndef ES_APP_BENCH_SYNTHETIC_ROM_TREE_H
+#define ES_APP_BENCH_SYNTHETIC_ROM_TREE_H
+
+#include <string>
+#include <boost/filesystem.hpp>
+
+// Describes the fake ROM collection es-bench boots against.
+struct SyntheticRomTreeParams
+{
+	unsigned int systems;
+	unsigned int gamesPerSystem;
+	unsigned int folderDepth; // games are spread over folders nested up to this deep, 0 puts everything in the system root
+	unsigned int artWidth; // size of the generated boxart, 0 for no artwork (basic gamelist views)
+	unsigned int artHeight;
+	unsigned int descriptionLength; // approximate number of characters in each game's description
+
+	SyntheticRomTreeParams() : systems(10), gamesPerSystem(500), folderDepth(1), artWidth(400), artHeight(560), descriptionLength(600) {}
+};
+
+// Writes a complete home directory under root: .emulationstation/es_systems.cfg, a keyboard es_input.cfg,
+// one gamelist per system, empty ROM files and artwork.
+// ES must then be pointed at it by setting HOME to root before anything calls getHomePath().
+bool createSyntheticRomTree(const boost::filesystem::path& root, const SyntheticRomTreeParams& params);
+
+#endif // ES_APP_BENCH_SYNTHETIC_ROM_TREE_H
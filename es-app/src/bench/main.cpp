@@ -0,0 +1,472 @@
+//es-bench, a headless benchmark harness for EmulationStation.
+//Boots the regular es-core/es-app stack against a generated ROM collection, replays a scripted
+//input sequence and reports startup time, frame time percentiles and peak memory as JSON.
+
+#include <SDL.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include "Renderer.h"
+#include "views/ViewController.h"
+#include "SystemData.h"
+#include "bench/SyntheticRomTree.h"
+#include "platform.h"
+#include "Log.h"
+#include "Window.h"
+#include "Settings.h"
+#include "EmulationStation.h"
+#include "InputManager.h"
+
+#ifdef WIN32
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace fs = boost::filesystem;
+
+// the simulated frame length fed to Window::update(), so animations and the script advance
+// identically no matter how fast the machine renders
+#define BENCH_FRAME_DELTA 16
+
+#define BENCH_DEFAULT_SCRIPT "enter,idle:30,scroll:180,page:10,jump,scroll:60,system:4,menu,back,idle:60"
+
+struct BenchOptions
+{
+	SyntheticRomTreeParams tree;
+	fs::path root;
+	bool keepTree;
+	bool offscreen;
+	unsigned int width;
+	unsigned int height;
+	std::string script;
+	std::string outPath;
+
+	BenchOptions() : keepTree(false), offscreen(false), width(1280), height(720), script(BENCH_DEFAULT_SCRIPT) {}
+};
+
+// a key press or release, delay frames after the previous one
+struct ScriptKey
+{
+	int delay;
+	SDL_Keycode key;
+	bool down;
+};
+
+struct ScriptStep
+{
+	std::string name;
+	std::vector<ScriptKey> keys;
+	int settleFrames; // frames to wait after the last key before the next step starts
+};
+
+struct StepResult
+{
+	std::string name;
+	std::vector<float> frameTimes;
+};
+
+static void setEnv(const char* name, const char* value, bool overwrite)
+{
+#ifdef WIN32
+	if(overwrite || getenv(name) == NULL)
+		_putenv_s(name, value);
+#else
+	setenv(name, value, overwrite ? 1 : 0);
+#endif
+}
+
+static long getPeakRSS()
+{
+#ifdef WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return (long)(counters.PeakWorkingSetSize / 1024);
+	return -1;
+#else
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) != 0)
+		return -1;
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024; // bytes on OS X
+#else
+	return usage.ru_maxrss; // kilobytes on Linux
+#endif
+#endif
+}
+
+static void press(ScriptStep& step, SDL_Keycode key, int delay, int holdFrames = 2)
+{
+	ScriptKey down = { delay, key, true };
+	ScriptKey up = { holdFrames, key, false };
+	step.keys.push_back(down);
+	step.keys.push_back(up);
+}
+
+// "name" or "name:count", see printHelp() for the list of actions
+static bool parseScript(const std::string& script, std::vector<ScriptStep>& steps)
+{
+	std::stringstream ss(script);
+	std::string token;
+	while(std::getline(ss, token, ','))
+	{
+		if(token.empty())
+			continue;
+
+		std::string action = token;
+		int count = 1;
+		size_t colon = token.find(':');
+		if(colon != std::string::npos)
+		{
+			action = token.substr(0, colon);
+			count = atoi(token.substr(colon + 1).c_str());
+			if(count <= 0)
+			{
+				std::cerr << "Invalid count in script step \"" << token << "\"\n";
+				return false;
+			}
+		}
+
+		ScriptStep step;
+		step.name = token;
+		step.settleFrames = 30;
+
+		if(action == "enter")
+		{
+			press(step, SDLK_RETURN, 0);
+			step.settleFrames = 60;
+		}else if(action == "back")
+		{
+			press(step, SDLK_ESCAPE, 0);
+			step.settleFrames = 60;
+		}else if(action == "scroll" || action == "scrollup")
+		{
+			// held down, so this measures the list's own scroll acceleration
+			press(step, action == "scroll" ? SDLK_DOWN : SDLK_UP, 0, count);
+			step.settleFrames = 10;
+		}else if(action == "page")
+		{
+			for(int i = 0; i < count; i++)
+				press(step, SDLK_LEFTBRACKET, i == 0 ? 0 : 6);
+		}else if(action == "jump")
+		{
+			// select opens the gamelist options, the first row is "jump to letter"
+			press(step, SDLK_F2, 0);
+			for(int i = 0; i < count * 5; i++)
+				press(step, SDLK_RIGHT, i == 0 ? 30 : 4);
+			press(step, SDLK_RETURN, 4);
+		}else if(action == "system")
+		{
+			for(int i = 0; i < count; i++)
+				press(step, SDLK_RIGHT, i == 0 ? 0 : 40);
+			step.settleFrames = 60;
+		}else if(action == "menu")
+		{
+			for(int i = 0; i < count; i++)
+			{
+				press(step, SDLK_F1, i == 0 ? 0 : 60);
+				press(step, SDLK_ESCAPE, 60);
+			}
+			step.settleFrames = 60;
+		}else if(action == "idle")
+		{
+			step.settleFrames = count;
+		}else{
+			std::cerr << "Unknown script action \"" << action << "\"\n";
+			return false;
+		}
+
+		steps.push_back(step);
+	}
+
+	return true;
+}
+
+static void printHelp()
+{
+	std::cout <<
+		"es-bench, a headless benchmark harness for EmulationStation.\n"
+		"Version " << PROGRAM_VERSION_STRING << ", built " << PROGRAM_BUILT_STRING << "\n\n"
+		"Command line arguments:\n"
+		"--systems [count]		number of generated systems (default 10)\n"
+		"--games [count]			games per system (default 500)\n"
+		"--depth [count]			folder nesting depth games are spread over (default 1)\n"
+		"--art [width] [height]		generated artwork size, 0 0 for none (default 400 560)\n"
+		"--desc [length]			characters per game description (default 600)\n"
+		"--resolution [width] [height]	window size (default 1280 720)\n"
+		"--script [steps]		comma separated input script (default " BENCH_DEFAULT_SCRIPT ")\n"
+		"				actions: enter, back, scroll:N, scrollup:N, page:N, jump:N, system:N, menu:N, idle:N\n"
+		"--root [path]			generate the ROM tree here and keep it (default is a temporary directory)\n"
+		"--offscreen			use SDL's offscreen video driver and software OpenGL\n"
+		"--out [file]			write the JSON report to a file instead of stdout\n"
+		"--help, -h			this text\n";
+}
+
+static bool parseArgs(int argc, char* argv[], BenchOptions& options)
+{
+	for(int i = 1; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+		const int remaining = argc - i - 1;
+
+		if(arg == "--systems" && remaining >= 1)
+			options.tree.systems = atoi(argv[++i]);
+		else if(arg == "--games" && remaining >= 1)
+			options.tree.gamesPerSystem = atoi(argv[++i]);
+		else if(arg == "--depth" && remaining >= 1)
+			options.tree.folderDepth = atoi(argv[++i]);
+		else if(arg == "--desc" && remaining >= 1)
+			options.tree.descriptionLength = atoi(argv[++i]);
+		else if(arg == "--art" && remaining >= 2)
+		{
+			options.tree.artWidth = atoi(argv[++i]);
+			options.tree.artHeight = atoi(argv[++i]);
+		}else if(arg == "--resolution" && remaining >= 2)
+		{
+			options.width = atoi(argv[++i]);
+			options.height = atoi(argv[++i]);
+		}else if(arg == "--script" && remaining >= 1)
+			options.script = argv[++i];
+		else if(arg == "--root" && remaining >= 1)
+		{
+			options.root = fs::absolute(argv[++i]);
+			options.keepTree = true;
+		}else if(arg == "--out" && remaining >= 1)
+			options.outPath = argv[++i];
+		else if(arg == "--offscreen")
+			options.offscreen = true;
+		else
+		{
+			printHelp();
+			return false;
+		}
+	}
+
+	if(options.tree.systems == 0 || options.tree.gamesPerSystem == 0)
+	{
+		std::cerr << "Need at least one system with at least one game.\n";
+		return false;
+	}
+
+	return true;
+}
+
+static float msSince(const std::chrono::high_resolution_clock::time_point& start)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count() / 1000.0f;
+}
+
+// nearest-rank percentile, values must be sorted
+static float percentile(const std::vector<float>& values, float p)
+{
+	if(values.empty())
+		return 0.0f;
+
+	size_t rank = (size_t)(p / 100.0f * values.size());
+	return values.at(std::min(rank, values.size() - 1));
+}
+
+static void writeFrameStats(std::ostream& out, std::vector<float> frameTimes)
+{
+	std::sort(frameTimes.begin(), frameTimes.end());
+
+	float total = 0.0f;
+	for(auto it = frameTimes.cbegin(); it != frameTimes.cend(); it++)
+		total += *it;
+
+	out << "{\"frames\":" << frameTimes.size()
+		<< ",\"mean_ms\":" << (frameTimes.empty() ? 0.0f : total / frameTimes.size())
+		<< ",\"p50_ms\":" << percentile(frameTimes, 50)
+		<< ",\"p90_ms\":" << percentile(frameTimes, 90)
+		<< ",\"p99_ms\":" << percentile(frameTimes, 99)
+		<< ",\"max_ms\":" << (frameTimes.empty() ? 0.0f : frameTimes.back()) << "}";
+}
+
+int main(int argc, char* argv[])
+{
+	const auto benchStart = std::chrono::high_resolution_clock::now();
+
+	BenchOptions options;
+	if(!parseArgs(argc, argv, options))
+		return 1;
+
+	std::vector<ScriptStep> script;
+	if(!parseScript(options.script, script))
+		return 1;
+
+	if(options.root.empty())
+		options.root = fs::temp_directory_path() / fs::unique_path("es-bench-%%%%-%%%%");
+
+	// everything ES reads and writes lives in the generated home directory, so point HOME there
+	// before anything calls getHomePath() (including Settings and the log)
+	fs::create_directories(options.root / ".emulationstation");
+	setEnv("HOME", options.root.generic_string().c_str(), true);
+	setEnv("SDL_AUDIODRIVER", "dummy", false);
+	if(options.offscreen)
+	{
+		setEnv("SDL_VIDEODRIVER", "offscreen", false);
+		setEnv("LIBGL_ALWAYS_SOFTWARE", "1", false);
+	}
+
+	std::locale::global(std::locale(std::locale(""), "C", std::locale::numeric));
+	boost::filesystem::path::imbue(std::locale());
+
+	Log::init();
+	Log::open();
+	LOG(LogInfo) << "es-bench - v" << PROGRAM_VERSION_STRING << ", built " << PROGRAM_BUILT_STRING;
+
+	std::cerr << "Generating " << options.tree.systems << " systems with " << options.tree.gamesPerSystem << " games in " << options.root << "...\n";
+	const auto generateStart = std::chrono::high_resolution_clock::now();
+	if(!createSyntheticRomTree(options.root, options.tree))
+	{
+		std::cerr << "Could not generate the ROM tree, see " << Log::getLogPath() << "\n";
+		return 1;
+	}
+	const float generateTime = msSince(generateStart);
+
+	Settings::getInstance()->setBool("Windowed", true);
+	Settings::getInstance()->setBool("VSync", false);
+	Settings::getInstance()->setInt("ScreenSaverTime", 0);
+
+	// from here on this mirrors the boot sequence in main.cpp
+	const auto bootStart = std::chrono::high_resolution_clock::now();
+
+	Window window;
+	ViewController::init(&window);
+	window.pushGui(ViewController::get());
+
+	if(!window.init(options.width, options.height))
+	{
+		std::cerr << "Window failed to initialize, see " << Log::getLogPath() << "\n";
+		return 1;
+	}
+	const float windowInitTime = msSince(bootStart);
+
+	if(Settings::getInstance()->getBool("SplashScreen"))
+		window.renderLoadingScreen();
+
+	auto phaseStart = std::chrono::high_resolution_clock::now();
+	if(!SystemData::loadConfig() || SystemData::sSystemVector.empty())
+	{
+		std::cerr << "Could not load the generated systems, see " << Log::getLogPath() << "\n";
+		return 1;
+	}
+	const float loadSystemsTime = msSince(phaseStart);
+
+	phaseStart = std::chrono::high_resolution_clock::now();
+	ViewController::get()->goToStart();
+	const float startViewTime = msSince(phaseStart);
+
+	window.update(BENCH_FRAME_DELTA);
+	window.render();
+	Renderer::swapBuffers();
+	const float startupTime = msSince(bootStart);
+
+	// play the script, one simulated frame at a time
+	std::vector<StepResult> results;
+	std::vector<float> allFrameTimes;
+	for(auto step = script.cbegin(); step != script.cend(); step++)
+	{
+		StepResult result;
+		result.name = step->name;
+
+		auto key = step->keys.cbegin();
+		int wait = (key != step->keys.cend() ? key->delay : 0);
+		int settle = step->settleFrames;
+
+		while(key != step->keys.cend() || settle > 0)
+		{
+			if(key != step->keys.cend())
+			{
+				// keys with no delay are sent on the same frame
+				while(key != step->keys.cend() && wait <= 0)
+				{
+					SDL_Event event;
+					SDL_memset(&event, 0, sizeof(event));
+					event.type = (key->down ? SDL_KEYDOWN : SDL_KEYUP);
+					event.key.state = (key->down ? SDL_PRESSED : SDL_RELEASED);
+					event.key.keysym.sym = key->key;
+					SDL_PushEvent(&event);
+
+					key++;
+					if(key != step->keys.cend())
+						wait = key->delay;
+				}
+				wait--;
+			}else{
+				settle--;
+			}
+
+			const auto frameStart = std::chrono::high_resolution_clock::now();
+
+			SDL_Event event;
+			while(SDL_PollEvent(&event))
+				InputManager::getInstance()->parseEvent(event, &window);
+
+			window.update(BENCH_FRAME_DELTA);
+			window.render();
+			Renderer::swapBuffers();
+
+			const float frameTime = msSince(frameStart);
+			result.frameTimes.push_back(frameTime);
+			allFrameTimes.push_back(frameTime);
+		}
+
+		results.push_back(result);
+	}
+
+	Log::flush();
+
+	std::stringstream report;
+	report << std::fixed << std::setprecision(3);
+	report << "{\"version\":\"" << PROGRAM_VERSION_STRING << "\""
+		<< ",\"systems\":" << options.tree.systems
+		<< ",\"games_per_system\":" << options.tree.gamesPerSystem
+		<< ",\"folder_depth\":" << options.tree.folderDepth
+		<< ",\"art_size\":[" << options.tree.artWidth << "," << options.tree.artHeight << "]"
+		<< ",\"resolution\":[" << Renderer::getScreenWidth() << "," << Renderer::getScreenHeight() << "]"
+		<< ",\"generate_ms\":" << generateTime
+		<< ",\"startup_ms\":" << startupTime
+		<< ",\"startup_phases_ms\":{\"window_init\":" << windowInitTime << ",\"load_systems\":" << loadSystemsTime << ",\"start_view\":" << startViewTime << "}"
+		<< ",\"frame_time\":";
+	writeFrameStats(report, allFrameTimes);
+	report << ",\"steps\":[";
+	for(auto it = results.cbegin(); it != results.cend(); it++)
+	{
+		report << (it == results.cbegin() ? "" : ",") << "{\"action\":\"" << it->name << "\",\"frame_time\":";
+		writeFrameStats(report, it->frameTimes);
+		report << "}";
+	}
+	report << "]"
+		<< ",\"peak_rss_kb\":" << getPeakRSS()
+		<< ",\"total_ms\":" << msSince(benchStart) << "}\n";
+
+	while(window.peekGui() != ViewController::get())
+		delete window.peekGui();
+	window.deinit();
+
+	SystemData::deleteSystems();
+
+	if(options.outPath.empty())
+	{
+		std::cout << report.str();
+	}else{
+		std::ofstream out(options.outPath.c_str());
+		out << report.str();
+		out.close();
+	}
+
+	LOG(LogInfo) << "es-bench finished.";
+	Log::close();
+
+	if(!options.keepTree)
+		fs::remove_all(options.root);
+
+	return 0;
+}
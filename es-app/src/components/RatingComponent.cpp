@@ -118,30 +118,8 @@ void RatingComponent::render(const Eigen::Affine3f& parentTrans)
 	Eigen::Affine3f trans = roundMatrix(parentTrans * getTransform());
 	Renderer::setMatrix(trans);
 
-	glEnable(GL_TEXTURE_2D);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	
-	glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].pos);
-	glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].tex);
-	glColorPointer(4, GL_UNSIGNED_BYTE, 0, mColors);
-	
-	mFilledTexture->bind();
-	glDrawArrays(GL_TRIANGLES, 0, 6);
-
-	mUnfilledTexture->bind();
-	glDrawArrays(GL_TRIANGLES, 6, 6);
-
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-	
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_BLEND);
+	Renderer::drawTriangles(mFilledTexture->getTextureId(), mVertices[0].pos.data(), mColors, 6);
+	Renderer::drawTriangles(mUnfilledTexture->getTextureId(), mVertices[6].pos.data(), mColors + 6 * 4, 6);
 
 	renderChildren(trans);
 }
@@ -225,6 +225,20 @@ void ScraperSearchComponent::stop()
 	mBlockAccept = false;
 }
 
+void ScraperSearchComponent::showResult(const ScraperSearchResult& result)
+{
+	stop();
+
+	// the image has already been downloaded, don't fetch it again for the thumbnail
+	mScraperResults.assign(1, result);
+	mScraperResults.front().imageUrl.clear();
+	mScraperResults.front().thumbnailUrl.clear();
+	updateInfoPane();
+
+	mResultThumbnail->setImage(result.mdl.get("image"));
+	mGrid.onSizeChanged(); // the thumbnail's size changed
+}
+
 void ScraperSearchComponent::onSearchDone(const std::vector<ScraperSearchResult>& results)
 {
 	mResultList->clear();
@@ -394,6 +408,10 @@ void ScraperSearchComponent::update(int deltaTime)
 		mBusyAnim.update(deltaTime);
 	}
 
+	// results can arrive any frame, and they change the screen
+	if(mThumbnailReq || mSearchHandle || mMDResolveHandle)
+		invalidate();
+
 	if(mThumbnailReq && mThumbnailReq->status() != HttpReq::REQ_IN_PROGRESS)
 	{
 		updateThumbnail();
@@ -439,7 +457,7 @@ void ScraperSearchComponent::updateThumbnail()
 {
 	if(mThumbnailReq && mThumbnailReq->status() == HttpReq::REQ_SUCCESS)
 	{
-		std::string content = mThumbnailReq->getContent();
+		const std::string& content = mThumbnailReq->getContent();
 		mResultThumbnail->setImage(content.data(), content.length());
 		mGrid.onSizeChanged(); // a hack to fix the thumbnail position since its size changed
 	}else{
@@ -10,6 +10,7 @@
 #include "Log.h"
 #include "ThemeData.h"
 #include "Util.h"
+#include "Window.h"
 #include <vector>
 #include <string>
 #include <memory>
@@ -39,6 +40,7 @@ public:
 	using IList<TextListData, T>::size;
 	using IList<TextListData, T>::isScrolling;
 	using IList<TextListData, T>::stopScrolling;
+	using IList<TextListData, T>::invalidate;
 
 	TextListComponent(Window* window);
 
@@ -297,7 +299,10 @@ void TextListComponent<T>::update(int deltaTime)
 			{
 				mMarqueeOffset += MARQUEE_RATE;
 				mMarqueeTime -= MARQUEE_SPEED;
+				invalidate();
 			}
+
+			this->mWindow->scheduleUpdate(MARQUEE_SPEED - mMarqueeTime);
 		}
 	}
 
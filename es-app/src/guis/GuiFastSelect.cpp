@@ -102,9 +102,12 @@ void GuiFastSelect::update(int deltaTime)
 		mScrollAccumulator += deltaTime;
 		while(mScrollAccumulator >= 150)
 		{
+			invalidate();
 			scroll();
 			mScrollAccumulator -= 150;
 		}
+
+		mWindow->scheduleUpdate(150 - mScrollAccumulator);
 	}
 
 	GuiComponent::update(deltaTime);
@@ -12,6 +12,8 @@
 
 using namespace Eigen;
 
+#define GAMELIST_SAVE_INTERVAL 25 // games accepted in batch mode between writes of the gamelists
+
 GuiScraperMulti::GuiScraperMulti(Window* window, const std::queue<ScraperSearchParams>& searches, bool approveResults) :
 	GuiComponent(window), mBackground(window, ":/frame.png"), mGrid(window, Vector2i(1, 5)),
 	mSearchQueue(searches)
@@ -27,6 +29,8 @@ GuiScraperMulti::GuiScraperMulti(Window* window, const std::queue<ScraperSearchP
 	mCurrentGame = 0;
 	mTotalSuccessful = 0;
 	mTotalSkipped = 0;
+	mUnsavedGames = 0;
+	mHasNewResult = false;
 
 	// set up grid
 	mTitle = std::make_shared<TextComponent>(mWindow, "SCRAPING IN PROGRESS", Font::get(FONT_SIZE_LARGE), 0x555555FF, ALIGN_CENTER);
@@ -68,7 +72,15 @@ GuiScraperMulti::GuiScraperMulti(Window* window, const std::queue<ScraperSearchP
 	setSize(Renderer::getScreenWidth() * 0.95f, Renderer::getScreenHeight() * 0.849f);
 	setPosition((Renderer::getScreenWidth() - mSize.x()) / 2, (Renderer::getScreenHeight() - mSize.y()) / 2);
 
-	doNextSearch();
+	if(approveResults)
+	{
+		doNextSearch();
+	}else{
+		mBatch = std::unique_ptr<ScraperBatch>(new ScraperBatch(mSearchQueue));
+		mBatch->setAcceptCallback(std::bind(&GuiScraperMulti::onBatchAccept, this, std::placeholders::_1, std::placeholders::_2));
+		mBatch->setSkipCallback(std::bind(&GuiScraperMulti::onBatchSkip, this, std::placeholders::_1));
+		updateBatchProgress();
+	}
 }
 
 GuiScraperMulti::~GuiScraperMulti()
@@ -89,6 +101,44 @@ void GuiScraperMulti::onSizeChanged()
 	mGrid.setSize(mSize);
 }
 
+void GuiScraperMulti::update(int deltaTime)
+{
+	GuiComponent::update(deltaTime);
+
+	if(!mBatch)
+		return;
+
+	// results can arrive any frame
+	invalidate();
+
+	mBatch->update();
+
+	// an update can accept several games, showing each would decode artwork no one gets to see
+	if(mHasNewResult)
+	{
+		mSearchComp->showResult(mNewResult);
+		mHasNewResult = false;
+	}
+
+	if(mBatch->isDone())
+		finish();
+	else
+		updateBatchProgress();
+}
+
+void GuiScraperMulti::updateBatchProgress()
+{
+	const ScraperSearchParams* search = mBatch->getOldestPending();
+	if(search == NULL)
+		return;
+
+	mSystem->setText(strToUpper(search->system->getFullName()));
+
+	std::stringstream ss;
+	ss << "GAME " << (mCurrentGame + 1) << " OF " << mTotalGames << " - " << strToUpper(search->game->getPath().filename().string());
+	mSubtitle->setText(ss.str());
+}
+
 void GuiScraperMulti::doNextSearch()
 {
 	if(mSearchQueue.empty())
@@ -109,11 +159,23 @@ void GuiScraperMulti::doNextSearch()
 	mSearchComp->search(mSearchQueue.front());
 }
 
+void GuiScraperMulti::applyResult(const ScraperSearchParams& search, const ScraperSearchResult& result)
+{
+	search.game->metadata = result.mdl;
+
+	// the first game with artwork turns a basic gamelist view into a detailed one
+	if(!search.system->hasArtwork() && search.game->hasArtwork())
+	{
+		search.system->setHasArtwork();
+		ViewController::get()->onFileChanged(search.game, FILE_METADATA_CHANGED);
+	}
+}
+
 void GuiScraperMulti::acceptResult(const ScraperSearchResult& result)
 {
 	ScraperSearchParams& search = mSearchQueue.front();
 
-	search.game->metadata = result.mdl;
+	applyResult(search, result);
 	updateGamelist(search.system);
 
 	mSearchQueue.pop();
@@ -130,8 +192,41 @@ void GuiScraperMulti::skip()
 	doNextSearch();
 }
 
+void GuiScraperMulti::onBatchAccept(const ScraperSearchParams& search, const ScraperSearchResult& result)
+{
+	applyResult(search, result);
+	mNewResult = result;
+	mHasNewResult = true;
+
+	mUnsavedSystems.insert(search.system);
+	if(++mUnsavedGames >= GAMELIST_SAVE_INTERVAL)
+		saveGamelists();
+
+	mCurrentGame++;
+	mTotalSuccessful++;
+}
+
+void GuiScraperMulti::onBatchSkip(const ScraperSearchParams& search)
+{
+	mCurrentGame++;
+	mTotalSkipped++;
+}
+
+void GuiScraperMulti::saveGamelists()
+{
+	for(auto it = mUnsavedSystems.cbegin(); it != mUnsavedSystems.cend(); it++)
+		updateGamelist(*it);
+
+	mUnsavedSystems.clear();
+	mUnsavedGames = 0;
+}
+
 void GuiScraperMulti::finish()
 {
+	// anything still in flight is dropped, but what was already accepted is kept
+	mBatch.reset();
+	saveGamelists();
+
 	std::stringstream ss;
 	if(mTotalSuccessful == 0)
 	{
@@ -6,8 +6,11 @@
 #include "components/NinePatchComponent.h"
 #include "components/ComponentGrid.h"
 #include "scrapers/Scraper.h"
+#include "scrapers/ScraperBatch.h"
 
+#include <memory>
 #include <queue>
+#include <set>
 
 class ScraperSearchComponent;
 class TextComponent;
@@ -18,6 +21,7 @@ public:
 	GuiScraperMulti(Window* window, const std::queue<ScraperSearchParams>& searches, bool approveResults);
 	virtual ~GuiScraperMulti();
 
+	void update(int deltaTime) override;
 	void onSizeChanged() override;
 	std::vector<HelpPrompt> getHelpPrompts() override;
 
@@ -26,6 +30,13 @@ private:
 	void skip();
 	void doNextSearch();
 
+	// without approval every game goes through mBatch instead of mSearchQueue and mSearchComp only shows what was found
+	void applyResult(const ScraperSearchParams& search, const ScraperSearchResult& result);
+	void onBatchAccept(const ScraperSearchParams& search, const ScraperSearchResult& result);
+	void onBatchSkip(const ScraperSearchParams& search);
+	void updateBatchProgress();
+	void saveGamelists();
+
 	void finish();
 
 	unsigned int mTotalGames;
@@ -34,6 +45,12 @@ private:
 	unsigned int mTotalSkipped;
 	std::queue<ScraperSearchParams> mSearchQueue;
 
+	std::unique_ptr<ScraperBatch> mBatch;
+	std::set<SystemData*> mUnsavedSystems; // gamelists are saved every few games in batch mode rather than after each one
+	unsigned int mUnsavedGames;
+	ScraperSearchResult mNewResult; // the last one accepted by mBatch, shown once its update() is done
+	bool mHasNewResult;
+
 	NinePatchComponent mBackground;
 	ComponentGrid mGrid;
 
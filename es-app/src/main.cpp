@@ -16,6 +16,8 @@
 #include "Window.h"
 #include "EmulationStation.h"
 #include "Settings.h"
+#include "BootReport.h"
+#include "BatchScrape.h"
 #include <sstream>
 #include <FreeImage.h>
 
@@ -60,6 +62,9 @@ bool parseArgs(int argc, char* argv[], unsigned int* width, unsigned int* height
 			Settings::getInstance()->setBool("Debug", true);
 			Settings::getInstance()->setBool("HideConsole", false);
 			Log::setReportingLevel(LogDebug);
+		}else if(strcmp(argv[i], "--boot-report") == 0)
+		{
+			Settings::getInstance()->setBool("BootReport", true);
 		}else if(strcmp(argv[i], "--windowed") == 0)
 		{
 			Settings::getInstance()->setBool("Windowed", true);
@@ -68,6 +73,80 @@ bool parseArgs(int argc, char* argv[], unsigned int* width, unsigned int* height
 			bool vsync = (strcmp(argv[i + 1], "on") == 0 || strcmp(argv[i + 1], "1") == 0) ? true : false;
 			Settings::getInstance()->setBool("VSync", vsync);
 			i++; // skip vsync value
+		}else if(strcmp(argv[i], "--max-fps") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "Invalid frame rate supplied.";
+				return false;
+			}
+
+			Settings::getInstance()->setInt("MaxFPS", atoi(argv[i + 1]));
+			i++; // skip the argument value
+		}else if(strcmp(argv[i], "--scraper-url") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "Invalid scraper URL supplied.";
+				return false;
+			}
+
+			Settings::getInstance()->setString("ScraperUrl", argv[i + 1]);
+			i++; // skip the argument value
+		}else if(strcmp(argv[i], "--scrape") == 0)
+		{
+			Settings::getInstance()->setBool("Scrape", true);
+			Settings::getInstance()->setBool("HideConsole", false);
+		}else if(strcmp(argv[i], "--scrape-systems") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "Invalid systems supplied.";
+				return false;
+			}
+
+			Settings::getInstance()->setString("ScrapeSystems", argv[i + 1]);
+			i++; // skip the argument value
+		}else if(strcmp(argv[i], "--scrape-filter") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "Invalid filter supplied.";
+				return false;
+			}
+
+			Settings::getInstance()->setString("ScrapeFilter", argv[i + 1]);
+			i++; // skip the argument value
+		}else if(strcmp(argv[i], "--scraper") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "Invalid scraper supplied.";
+				return false;
+			}
+
+			Settings::getInstance()->setString("ScrapeScraper", argv[i + 1]);
+			i++; // skip the argument value
+		}else if(strcmp(argv[i], "--scrape-searches") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "Invalid number of searches supplied.";
+				return false;
+			}
+
+			Settings::getInstance()->setInt("ScrapeMaxSearches", atoi(argv[i + 1]));
+			i++; // skip the argument value
+		}else if(strcmp(argv[i], "--scrape-downloads") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "Invalid number of downloads supplied.";
+				return false;
+			}
+
+			Settings::getInstance()->setInt("ScrapeMaxDownloads", atoi(argv[i + 1]));
+			i++; // skip the argument value
 		}else if(strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
 		{
 #ifdef WIN32
@@ -91,8 +170,17 @@ bool parseArgs(int argc, char* argv[], unsigned int* width, unsigned int* height
 				"--force-kiosk			hide all configurations, don't display any menus, including exit\n"
 				"--no-splash			don't show the splash screen\n"
 				"--debug				more logging, show console on Windows\n"
+				"--boot-report			write startup timings to ~/.emulationstation/es_boot.json\n"
 				"--windowed			not fullscreen, should be used with --resolution\n"
 				"--vsync [1/on or 0/off]		turn vsync on or off (default is on)\n"
+				"--max-fps [n]			draw at most n frames per second (default is no limit)\n"
+				"--scraper-url [url]		send scraper requests to url instead of the scraper's own server\n"
+				"--scrape			scrape without a window, write the gamelists and exit\n"
+				"--scrape-systems [a,b,...]	systems to scrape with --scrape (default is every system with a platform)\n"
+				"--scrape-filter [all/missing]	games to scrape with --scrape (default is only games missing an image)\n"
+				"--scraper [name]		scraper to use with --scrape (default is the one set in the menu)\n"
+				"--scrape-searches [n]		searches to run at once with --scrape\n"
+				"--scrape-downloads [n]		images to download at once with --scrape\n"
 				"--help, -h			summon a sentient, angry tuba\n\n"
 				"More information available in README.md.\n";
 			return false; //exit after printing help
@@ -122,11 +210,12 @@ bool verifyHomeFolderExists()
 }
 
 // Returns true if everything is OK,
-bool loadSystemConfigFile(const char** errorString)
+// Only waits for the first system to load, the others become available as they finish (see ViewController::addLoadedSystems()).
+bool loadSystemConfigFile(Window* window, const char** errorString)
 {
 	*errorString = NULL;
 
-	if(!SystemData::loadConfig())
+	if(!SystemData::loadConfigAsync())
 	{
 		LOG(LogError) << "Error while parsing systems configuration file!";
 		*errorString = "IT LOOKS LIKE YOUR SYSTEMS CONFIGURATION FILE HAS NOT BEEN SET UP OR IS INVALID. YOU'LL NEED TO DO THIS BY HAND, UNFORTUNATELY.\n\n"
@@ -134,6 +223,23 @@ bool loadSystemConfigFile(const char** errorString)
 		return false;
 	}
 
+	const bool showProgress = Settings::getInstance()->getBool("SplashScreen");
+	unsigned int shownProgress = 0;
+	while(SystemData::sSystemVector.empty() && SystemData::isLoading())
+	{
+		SDL_Delay(10);
+		SystemData::collectLoadedSystems();
+
+		// systems without games don't count as the first system, so the bar can move before we're done here
+		unsigned int loaded, total;
+		SystemData::getLoadProgress(&loaded, &total);
+		if(showProgress && loaded != shownProgress)
+		{
+			window->renderLoadingScreen("LOADING...", (float)loaded / total);
+			shownProgress = loaded;
+		}
+	}
+
 	if(SystemData::sSystemVector.size() == 0)
 	{
 		LOG(LogError) << "No systems found! Does at least one system have a game present? (check that extensions match!)\n(Also, make sure you've updated your es_systems.cfg for XML!)";
@@ -161,8 +267,14 @@ int main(int argc, char* argv[])
 	std::locale::global(std::locale(std::locale(""), "C", std::locale::numeric));
 	boost::filesystem::path::imbue(std::locale());
 
-	if(!parseArgs(argc, argv, &width, &height))
-		return 0;
+	{
+		BootReport::Phase phase("settings");
+		if(!parseArgs(argc, argv, &width, &height))
+			return 0;
+
+		// parseArgs() only loads the settings file if an argument needs it
+		Settings::getInstance();
+	}
 
 	// only show the console on Windows if HideConsole is false
 #ifdef WIN32
@@ -207,31 +319,47 @@ int main(int argc, char* argv[])
 		return 1;
 
 	//start the logger
-	Log::init();
-	Log::open();
+	{
+		BootReport::Phase phase("log");
+		Log::init();
+		Log::open();
+	}
 	LOG(LogInfo) << "EmulationStation - v" << PROGRAM_VERSION_STRING << ", built " << PROGRAM_BUILT_STRING;
 
 	//always close the log on exit
 	atexit(&onExit);
 
-	Window window;
-	ViewController::init(&window);
-	window.pushGui(ViewController::get());
+	// no window, no renderer
+	if(Settings::getInstance()->getBool("Scrape"))
+		return runBatchScrape();
 
-	if(!window.init(width, height))
+	Window window;
 	{
-		LOG(LogError) << "Window failed to initialize!";
-		return 1;
+		BootReport::Phase phase("window");
+		ViewController::init(&window);
+		window.pushGui(ViewController::get());
+
+		if(!window.init(width, height))
+		{
+			LOG(LogError) << "Window failed to initialize!";
+			return 1;
+		}
 	}
 
-	std::string glExts = (const char*)glGetString(GL_EXTENSIONS);
-	LOG(LogInfo) << "Checking available OpenGL extensions...";
-	LOG(LogInfo) << " ARB_texture_non_power_of_two: " << (glExts.find("ARB_texture_non_power_of_two") != std::string::npos ? "ok" : "MISSING");
 	if(Settings::getInstance()->getBool("SplashScreen"))
-		window.renderLoadingScreen();
+	{
+		BootReport::Phase phase("splash");
+		window.renderLoadingScreen("LOADING...", 0.0f);
+	}
 
 	const char* errorMsg = NULL;
-	if(!loadSystemConfigFile(&errorMsg))
+	bool systemsLoaded;
+	{
+		BootReport::Phase phase("systems");
+		systemsLoaded = loadSystemConfigFile(&window, &errorMsg);
+	}
+
+	if(!systemsLoaded)
 	{
 		// something went terribly wrong
 		if(errorMsg == NULL)
@@ -254,13 +382,10 @@ int main(int argc, char* argv[])
 	//dont generate joystick events while we're loading (hopefully fixes "automatically started emulator" bug)
 	SDL_JoystickEventState(SDL_DISABLE);
 
-	// preload what we can right away instead of waiting for the user to select it
-	// this makes for no delays when accessing content, but a longer startup time
-	ViewController::get()->preload();
-
 	//choose which GUI to open depending on if an input configuration already exists
 	if(errorMsg == NULL)
 	{
+		BootReport::Phase phase("start view");
 		if(fs::exists(InputManager::getConfigPath()) && InputManager::getInstance()->getNumConfiguredDevices() > 0)
 		{
 			ViewController::get()->goToStart();
@@ -272,6 +397,14 @@ int main(int argc, char* argv[])
 	//generate joystick events since we're done loading
 	SDL_JoystickEventState(SDL_ENABLE);
 
+	{
+		BootReport::Phase phase("first frame");
+		window.update(0);
+		window.render();
+		Renderer::swapBuffers();
+	}
+
+	const int maxFPS = Settings::getInstance()->getInt("MaxFPS");
 	int lastTime = SDL_GetTicks();
 	bool running = true;
 
@@ -284,12 +417,14 @@ int main(int argc, char* argv[])
 
 			if(event.type == SDL_QUIT)
 				running = false;
+			else if(event.type == SDL_WINDOWEVENT)
+				window.invalidate(); // exposed, resized, restored...
 		}
 
 		if(window.isSleeping())
 		{
+			SDL_WaitEvent(NULL); // only input wakes us up
 			lastTime = SDL_GetTicks();
-			SDL_Delay(1); // this doesn't need to be accurate, we're just giving up our CPU time until something wakes us up
 			continue;
 		}
 
@@ -302,12 +437,31 @@ int main(int argc, char* argv[])
 			deltaTime = 1000;
 
 		window.update(deltaTime);
-		window.render();
-		Renderer::swapBuffers();
+
+		const bool drawn = window.isDirty();
+		if(drawn)
+		{
+			window.render();
+			Renderer::swapBuffers();
+		}
+
+		// booting is done once the last system has loaded in the background
+		if(!BootReport::isFinished() && !SystemData::isLoading())
+			BootReport::finish();
 
 		Log::flush();
+
+		// if nothing changed, nothing will until there is input or a timer is due, so wait instead of spinning;
+		// input still ends the wait right away, so it isn't delayed by the frame cap either
+		int waitTime = drawn ? 0 : window.getTimeUntilUpdate();
+		if(drawn && maxFPS > 0)
+			waitTime = 1000 / maxFPS - (int)(SDL_GetTicks() - curTime);
+		if(waitTime > 0)
+			SDL_WaitEventTimeout(NULL, waitTime);
 	}
 
+	LOG(LogInfo) << window.getDroppedFrames() << " frames dropped.";
+
 	while(window.peekGui() != ViewController::get())
 		delete window.peekGui();
 	window.deinit();
@@ -103,7 +103,7 @@ void thegamesdb_generate_json_scraper_requests(const ScraperSearchParams& params
 	std::queue<std::unique_ptr<ScraperRequest>>& requests, std::vector<ScraperSearchResult>& results)
 {
 	resources.prepare();
-	std::string path = "https://api.thegamesdb.net";
+	std::string path = getScraperBaseUrl("https://api.thegamesdb.net");
 	bool usingGameID = false;
 	const std::string apiKey = std::string("apikey=") + resources.getApiKey();
 	std::string cleanName = params.nameOverride;
@@ -338,6 +338,17 @@ void processGame(const Value& game, const Value& boxart, std::vector<ScraperSear
 }
 } // namespace
 
+void TheGamesDBJSONRequest::update()
+{
+	// the search itself runs alongside the resource fetches, but its results need the names in them
+	if (!resources.isReady())
+	{
+		return;
+	}
+
+	ScraperHttpRequest::update();
+}
+
 void TheGamesDBJSONRequest::process(const std::unique_ptr<HttpReq>& req, std::vector<ScraperSearchResult>& results)
 {
 	assert(req->status() == HttpReq::REQ_SUCCESS);
@@ -378,9 +389,6 @@ void TheGamesDBJSONRequest::process(const std::unique_ptr<HttpReq>& req, std::ve
 		return;
 	}
 
-	resources.ensureResources();
-
-
 	for (int i = 0; i < games.Size(); ++i)
 	{
 		auto& v = games[i];
@@ -27,6 +27,8 @@ class TheGamesDBJSONRequest : public ScraperHttpRequest
 	{
 	}
 
+	void update() override;
+
   protected:
 	void process(const std::unique_ptr<HttpReq>& req, std::vector<ScraperSearchResult>& results) override;
 	bool isGameRequest() { return !mRequestQueue; }
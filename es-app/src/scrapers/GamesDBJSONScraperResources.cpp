@@ -1,11 +1,13 @@
+#include <algorithm>
 #include <chrono>
+#include <ctime>
 #include <fstream>
 #include <memory>
-#include <thread>
 
 #include "Log.h"
 
 #include "scrapers/GamesDBJSONScraperResources.h"
+#include "scrapers/Scraper.h"
 #include "platform.h"
 #include "Util.h"
 
@@ -22,8 +24,8 @@ constexpr char GamesDBAPIKey[] = "445fcbc3f32bb2474bc27016b99eb963d318ee3a608212
 
 
 constexpr int MAX_WAIT_MS = 90000;
-constexpr int POLL_TIME_MS = 500;
-constexpr int MAX_WAIT_ITER = MAX_WAIT_MS / POLL_TIME_MS;
+constexpr int RETRY_DELAY_MS = 5 * 60 * 1000;
+constexpr std::time_t RESOURCE_MAX_AGE = 7 * 24 * 60 * 60; // seconds
 
 constexpr char SCRAPER_RESOURCES_DIR[] = "scrapers";
 constexpr char DEVELOPERS_JSON_FILE[] = "gamesdb_developers.json";
@@ -38,6 +40,13 @@ std::string genFilePath(const std::string& file_name)
 	return boost::filesystem::path(getScrapersResouceDir() + "/" + file_name).generic_string();
 }
 
+bool isExpired(const std::string& path)
+{
+	boost::system::error_code ec;
+	const std::time_t modified = boost::filesystem::last_write_time(path, ec);
+	return ec || std::time(nullptr) - modified > RESOURCE_MAX_AGE;
+}
+
 void ensureScrapersResourcesDir()
 {
 	std::string path = getScrapersResouceDir();
@@ -60,102 +69,105 @@ std::string TheGamesDBJSONRequestResources::getApiKey() const { return GamesDBAP
 
 void TheGamesDBJSONRequestResources::prepare()
 {
-	if (checkLoaded())
-	{
-		return;
-	}
+	prepareResource(gamesdb_developers_resource_request, gamesdb_new_developers_map, "developers", DEVELOPERS_JSON_FILE,
+		DEVELOPERS_ENDPOINT);
+	prepareResource(gamesdb_publishers_resource_request, gamesdb_new_publishers_map, "publishers", PUBLISHERS_JSON_FILE,
+		PUBLISHERS_ENDPOINT);
+	prepareResource(gamesdb_genres_resource_request, gamesdb_new_genres_map, "genres", GENRES_JSON_FILE, GENRES_ENDPOINT);
+}
 
-	if (loadResource(gamesdb_new_developers_map, "developers", genFilePath(DEVELOPERS_JSON_FILE)) &&
-		!gamesdb_developers_resource_request)
-	{
-		gamesdb_developers_resource_request = fetchResource(DEVELOPERS_ENDPOINT);
-	}
-	if (loadResource(gamesdb_new_publishers_map, "publishers", genFilePath(PUBLISHERS_JSON_FILE)) &&
-		!gamesdb_publishers_resource_request)
+bool TheGamesDBJSONRequestResources::isReady()
+{
+	saveResource(gamesdb_developers_resource_request, gamesdb_new_developers_map, "developers", DEVELOPERS_JSON_FILE);
+	saveResource(gamesdb_publishers_resource_request, gamesdb_new_publishers_map, "publishers", PUBLISHERS_JSON_FILE);
+	saveResource(gamesdb_genres_resource_request, gamesdb_new_genres_map, "genres", GENRES_JSON_FILE);
+
+	// an expired table is still good enough to look names up in while the new one is on its way
+	return (!gamesdb_developers_resource_request || !gamesdb_new_developers_map.empty()) &&
+		   (!gamesdb_publishers_resource_request || !gamesdb_new_publishers_map.empty()) &&
+		   (!gamesdb_genres_resource_request || !gamesdb_new_genres_map.empty());
+}
+
+void TheGamesDBJSONRequestResources::prepareResource(std::unique_ptr<HttpReq>& req,
+	std::unordered_map<int, std::string>& resource, const std::string& resource_name, const std::string& file_name,
+	const std::string& endpoint)
+{
+	if (req)
 	{
-		gamesdb_publishers_resource_request = fetchResource(PUBLISHERS_ENDPOINT);
+		return; // already on its way
 	}
-	if (loadResource(gamesdb_new_genres_map, "genres", genFilePath(GENRES_JSON_FILE)) && !gamesdb_genres_resource_request)
+
+	const std::string path = genFilePath(file_name);
+	if (resource.empty())
 	{
-		gamesdb_genres_resource_request = fetchResource(GENRES_ENDPOINT);
+		loadResource(resource, resource_name, path);
 	}
-}
 
-void TheGamesDBJSONRequestResources::ensureResources()
-{
-
-	if (checkLoaded())
+	if (!resource.empty() && !isExpired(path))
 	{
 		return;
 	}
 
-
-	for (int i = 0; i < MAX_WAIT_ITER; ++i)
+	const auto now = std::chrono::steady_clock::now();
+	if (now < next_fetch)
 	{
-		if (gamesdb_developers_resource_request &&
-			saveResource(gamesdb_developers_resource_request.get(), gamesdb_new_developers_map, "developers",
-				genFilePath(DEVELOPERS_JSON_FILE)))
-		{
-
-			gamesdb_developers_resource_request.reset(nullptr);
-		}
-		if (gamesdb_publishers_resource_request &&
-			saveResource(gamesdb_publishers_resource_request.get(), gamesdb_new_publishers_map, "publishers",
-				genFilePath(PUBLISHERS_JSON_FILE)))
-		{
-			gamesdb_publishers_resource_request.reset(nullptr);
-		}
-		if (gamesdb_genres_resource_request && saveResource(gamesdb_genres_resource_request.get(), gamesdb_new_genres_map,
-												   "genres", genFilePath(GENRES_JSON_FILE)))
-		{
-			gamesdb_genres_resource_request.reset(nullptr);
-		}
-
-		if (!gamesdb_developers_resource_request && !gamesdb_publishers_resource_request && !gamesdb_genres_resource_request)
-		{
-			return;
-		}
-		std::this_thread::sleep_for(std::chrono::milliseconds(POLL_TIME_MS));
+		return;
 	}
-	LOG(LogError) << "Timed out while waiting for resources\n";
-}
 
-bool TheGamesDBJSONRequestResources::checkLoaded()
-{
-	return !gamesdb_new_genres_map.empty() && !gamesdb_new_developers_map.empty() && !gamesdb_new_publishers_map.empty();
+	req = fetchResource(endpoint);
+	fetch_started = now;
 }
 
-bool TheGamesDBJSONRequestResources::saveResource(HttpReq* req, std::unordered_map<int, std::string>& resource,
-	const std::string& resource_name, const std::string& file_name)
+bool TheGamesDBJSONRequestResources::saveResource(std::unique_ptr<HttpReq>& req,
+	std::unordered_map<int, std::string>& resource, const std::string& resource_name, const std::string& file_name)
 {
-
-	if (req == nullptr)
+	if (!req)
 	{
-		LOG(LogError) << "Http request pointer was null\n";
 		return true;
 	}
+
+	const auto now = std::chrono::steady_clock::now();
 	if (req->status() == HttpReq::REQ_IN_PROGRESS)
 	{
-		return false; // Not ready: wait some more
+		if (now - fetch_started < std::chrono::milliseconds(MAX_WAIT_MS))
+		{
+			return false; // Not ready: wait some more
+		}
+
+		LOG(LogError) << "Timed out while fetching resource " << file_name;
+		req.reset();
+		next_fetch = now + std::chrono::milliseconds(RETRY_DELAY_MS);
+		return true;
 	}
 	if (req->status() != HttpReq::REQ_SUCCESS)
 	{
 		LOG(LogError) << "Resource request for " << file_name << " failed:\n\t" << req->getErrorMsg();
-		return true; // Request failed, resetting request.
+		req.reset();
+		next_fetch = now + std::chrono::milliseconds(RETRY_DELAY_MS);
+		return true;
+	}
+
+	std::string content = req->takeContent();
+	req.reset();
+
+	// parsing happens in place, keep the original to write out
+	std::string json = content;
+	if (!parseResource(json, resource, resource_name))
+	{
+		next_fetch = now + std::chrono::milliseconds(RETRY_DELAY_MS);
+		return true;
 	}
 
 	ensureScrapersResourcesDir();
 
-	std::ofstream fout(file_name);
-	fout << req->getContent();
-	fout.close();
-	loadResource(resource, resource_name, file_name);
+	std::ofstream fout(genFilePath(file_name), std::ios_base::out | std::ios_base::binary);
+	fout.write(content.data(), content.length());
 	return true;
 }
 
 std::unique_ptr<HttpReq> TheGamesDBJSONRequestResources::fetchResource(const std::string& endpoint)
 {
-	std::string path = "https://api.thegamesdb.net";
+	std::string path = getScraperBaseUrl("https://api.thegamesdb.net");
 	path += endpoint;
 	path += "?apikey=" + getApiKey();
 
@@ -163,27 +175,39 @@ std::unique_ptr<HttpReq> TheGamesDBJSONRequestResources::fetchResource(const std
 }
 
 
-int TheGamesDBJSONRequestResources::loadResource(
+bool TheGamesDBJSONRequestResources::loadResource(
 	std::unordered_map<int, std::string>& resource, const std::string& resource_name, const std::string& file_name)
 {
-
-
-	std::ifstream fin(file_name);
+	std::ifstream fin(file_name, std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
 	if (!fin.good())
 	{
-		return 1;
+		return false;
 	}
-	std::stringstream buffer;
-	buffer << fin.rdbuf();
+
+	// read it in one go, no stream buffer copies
+	std::string json((size_t)fin.tellg(), '\0');
+	fin.seekg(0);
+	fin.read(&json[0], json.length());
+	if (fin.fail())
+	{
+		return false;
+	}
+
+	return parseResource(json, resource, resource_name);
+}
+
+bool TheGamesDBJSONRequestResources::parseResource(
+	std::string& json, std::unordered_map<int, std::string>& resource, const std::string& resource_name)
+{
 	Document doc;
-	doc.Parse(buffer.str().c_str());
+	doc.ParseInsitu(&json[0]);
 
 	if (doc.HasParseError())
 	{
-		std::string err = std::string("TheGamesDBJSONRequest - Error parsing JSON for resource file ") + file_name +
+		std::string err = std::string("TheGamesDBJSONRequest - Error parsing JSON for resource ") + resource_name +
 						  ":\n\t" + GetParseError_En(doc.GetParseError());
 		LOG(LogError) << err;
-		return 1;
+		return false;
 	}
 
 	if (!doc.HasMember("data") || !doc["data"].HasMember(resource_name.c_str()) ||
@@ -191,10 +215,12 @@ int TheGamesDBJSONRequestResources::loadResource(
 	{
 		std::string err = "TheGamesDBJSONRequest - Response had no resource data.\n";
 		LOG(LogError) << err;
-		return 1;
+		return false;
 	}
 	auto& data = doc["data"][resource_name.c_str()];
 
+	std::unordered_map<int, std::string> parsed;
+	parsed.reserve(data.MemberCount());
 	for (Value::ConstMemberIterator itr = data.MemberBegin(); itr != data.MemberEnd(); ++itr)
 	{
 		auto& entry = itr->value;
@@ -203,7 +229,14 @@ int TheGamesDBJSONRequestResources::loadResource(
 		{
 			continue;
 		}
-		resource[entry["id"].GetInt()] = entry["name"].GetString();
+		parsed[entry["id"].GetInt()] = entry["name"].GetString();
 	}
-	return resource.empty();
+
+	if (parsed.empty())
+	{
+		return false;
+	}
+
+	resource.swap(parsed);
+	return true;
 }
@@ -2,7 +2,7 @@
 #ifndef ES_APP_SCRAPERS_GAMES_DB_JSON_SCRAPER_RESOURCES_H
 #define ES_APP_SCRAPERS_GAMES_DB_JSON_SCRAPER_RESOURCES_H
 
-#include <fstream>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -10,12 +10,17 @@
 #include "HttpReq.h"
 
 
+// The developer, publisher and genre names TheGamesDB only gives out by id. They are kept in ~/.emulationstation/scrapers,
+// read from there the first time a search needs them and fetched again in the background once the files are a week old.
+// Nothing here blocks: searches poll isReady() and wait in their queue until there is something to look names up in.
 struct TheGamesDBJSONRequestResources
 {
 	TheGamesDBJSONRequestResources() = default;
 
+	// Loads whatever is on disk and starts fetching the tables that are missing or expired, all three at once.
 	void prepare();
-	void ensureResources();
+	// Picks up finished fetches. False while a table we have nothing for at all is still being fetched.
+	bool isReady();
 	std::string getApiKey() const;
 
 	std::unordered_map<int, std::string> gamesdb_new_developers_map;
@@ -23,18 +28,25 @@ struct TheGamesDBJSONRequestResources
 	std::unordered_map<int, std::string> gamesdb_new_genres_map;
 
   private:
-	bool checkLoaded();
-
-	bool saveResource(HttpReq* req, std::unordered_map<int, std::string>& resource, const std::string& resource_name,
-		const std::string& file_name);
+	void prepareResource(std::unique_ptr<HttpReq>& req, std::unordered_map<int, std::string>& resource,
+		const std::string& resource_name, const std::string& file_name, const std::string& endpoint);
+	// Returns false while req is still running.
+	bool saveResource(std::unique_ptr<HttpReq>& req, std::unordered_map<int, std::string>& resource,
+		const std::string& resource_name, const std::string& file_name);
 	std::unique_ptr<HttpReq> fetchResource(const std::string& endpoint);
 
-	int loadResource(
+	bool loadResource(
 		std::unordered_map<int, std::string>& resource, const std::string& resource_name, const std::string& file_name);
+	// json is parsed in place and left unusable.
+	bool parseResource(
+		std::string& json, std::unordered_map<int, std::string>& resource, const std::string& resource_name);
 
 	std::unique_ptr<HttpReq> gamesdb_developers_resource_request;
 	std::unique_ptr<HttpReq> gamesdb_publishers_resource_request;
 	std::unique_ptr<HttpReq> gamesdb_genres_resource_request;
+
+	std::chrono::steady_clock::time_point fetch_started;
+	std::chrono::steady_clock::time_point next_fetch; // held back after a failure so every search doesn't retry
 };
 
 std::string getScrapersResouceDir();
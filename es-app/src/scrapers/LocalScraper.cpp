@@ -0,0 +1,172 @@
+#include "scrapers/LocalScraper.h"
+#include "FileData.h"
+#include "Log.h"
+#include "platform.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include "Util.h"
+#include "pugixml.hpp"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <unordered_map>
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+	// what the online scrapers fill in, the rest of a game's metadata belongs to whoever put the dataset together
+	const char* SCRAPED_KEYS[] = { "name", "desc", "rating", "releasedate", "developer", "publisher", "genre", "players" };
+
+	struct SystemIndex
+	{
+		std::vector<ScraperSearchResult> games;
+		std::vector<std::string> names; // lowercase, same order as games
+		std::unordered_map<std::string, size_t> byCrc; // lowercase hex, from the games' <crc> tags
+		std::unordered_map<std::string, size_t> byFile; // lowercase ROM file name without its extension
+		std::unordered_map<std::string, size_t> byName; // lowercase
+	};
+
+	// by system name, only ever touched from the thread running the scraper
+	std::map< std::string, std::unique_ptr<SystemIndex> > sIndexes;
+
+	std::string toLower(std::string str)
+	{
+		std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+		return str;
+	}
+
+	fs::path getDatasetPath()
+	{
+		const std::string& path = Settings::getInstance()->getString("LocalScraperPath");
+		if(path.empty())
+			return fs::path(getHomePath()) / ".emulationstation" / "scrapers" / "local";
+
+		return resolvePath(path, fs::current_path(), true);
+	}
+
+	// so the artwork goes through the same download, resize and save as everyone else's
+	std::string toFileUrl(const fs::path& path)
+	{
+		std::string url = "file://";
+		for(auto it = path.begin(); it != path.end(); it++)
+		{
+			if(*it == "/")
+				continue;
+
+			url += "/" + HttpReq::urlEncode(it->string());
+		}
+
+		return url;
+	}
+
+	// an empty index if the system has no dataset
+	std::unique_ptr<SystemIndex> loadIndex(const std::string& systemName)
+	{
+		std::unique_ptr<SystemIndex> index(new SystemIndex());
+
+		const fs::path path = getDatasetPath() / systemName / "gamelist.xml";
+		if(!fs::exists(path))
+		{
+			LOG(LogWarning) << "No local scraper data for " << systemName << " (looked for \"" << path.generic_string() << "\")";
+			return index;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+
+		pugi::xml_document doc;
+		pugi::xml_parse_result result = doc.load_file(path.c_str());
+		if(!result)
+		{
+			LOG(LogError) << "Error parsing local scraper data \"" << path.generic_string() << "\": " << result.description();
+			return index;
+		}
+
+		const fs::path relativeTo = path.parent_path();
+		for(pugi::xml_node node = doc.child("gameList").child("game"); node; node = node.next_sibling("game"))
+		{
+			const MetaDataList mdl = MetaDataList::createFromXML(GAME_METADATA, node, relativeTo);
+
+			ScraperSearchResult game;
+			for(size_t i = 0; i < sizeof(SCRAPED_KEYS) / sizeof(SCRAPED_KEYS[0]); i++)
+				game.mdl.set(SCRAPED_KEYS[i], mdl.get(SCRAPED_KEYS[i]));
+
+			// "./" paths are already resolved, anything else relative is taken as relative to the gamelist too
+			if(!mdl.get("image").empty())
+				game.imageUrl = toFileUrl(fs::absolute(mdl.get("image"), relativeTo));
+			if(!mdl.get("thumbnail").empty())
+				game.thumbnailUrl = toFileUrl(fs::absolute(mdl.get("thumbnail"), relativeTo));
+
+			const size_t i = index->games.size();
+			index->games.push_back(game);
+			index->names.push_back(toLower(mdl.get("name")));
+
+			// the first game with a given checksum, file name or name wins
+			const std::string crc = toLower(node.child("crc").text().get());
+			if(!crc.empty())
+				index->byCrc.insert(std::make_pair(crc, i));
+			const std::string file = toLower(fs::path(node.child("path").text().get()).stem().string());
+			if(!file.empty())
+				index->byFile.insert(std::make_pair(file, i));
+			if(!index->names.back().empty())
+				index->byName.insert(std::make_pair(index->names.back(), i));
+		}
+
+		LOG(LogInfo) << "Indexed " << index->games.size() << " games of local scraper data for " << systemName << " in " <<
+			std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << "ms";
+
+		return index;
+	}
+
+	const SystemIndex& getIndex(const std::string& systemName)
+	{
+		std::unique_ptr<SystemIndex>& index = sIndexes[systemName];
+		if(!index)
+			index = loadIndex(systemName);
+
+		return *index;
+	}
+}
+
+void local_generate_scraper_requests(const ScraperSearchParams& params, std::queue< std::unique_ptr<ScraperRequest> >& requests,
+	std::vector<ScraperSearchResult>& results)
+{
+	// nothing to wait for, so no requests: the results are there as soon as the search starts
+	const SystemIndex& index = getIndex(params.system->getName());
+
+	if(!params.nameOverride.empty())
+	{
+		// typed in by hand, so the exact name first and then every name containing it
+		const std::string name = toLower(params.nameOverride);
+
+		auto it = index.byName.find(name);
+		if(it != index.byName.cend())
+			results.push_back(index.games[it->second]);
+
+		for(size_t i = 0; i < index.names.size() && results.size() < MAX_SCRAPER_RESULTS; i++)
+		{
+			if(index.names[i] != name && index.names[i].find(name) != std::string::npos)
+				results.push_back(index.games[i]);
+		}
+
+		return;
+	}
+
+	auto it = index.byCrc.find(params.romHash.crc32);
+	if(it != index.byCrc.cend())
+	{
+		results.push_back(index.games[it->second]);
+		return;
+	}
+
+	it = index.byFile.find(toLower(params.game->getPath().stem().string()));
+	if(it != index.byFile.cend())
+	{
+		results.push_back(index.games[it->second]);
+		return;
+	}
+
+	it = index.byName.find(toLower(params.game->getCleanName()));
+	if(it != index.byName.cend())
+		results.push_back(index.games[it->second]);
+}
@@ -0,0 +1,16 @@
+#pragma once
+#ifndef ES_APP_SCRAPERS_LOCAL_SCRAPER_H
+#define ES_APP_SCRAPERS_LOCAL_SCRAPER_H
+
+#include "scrapers/Scraper.h"
+
+// An offline scraper: answers searches from gamelists kept in Settings "LocalScraperPath"
+// (~/.emulationstation/scrapers/local if empty), one per system as [system name]/gamelist.xml, in the same format
+// ES writes its own gamelists in. Games are found by the CRC32 of the ROM in an extra <crc> tag, then by ROM file name,
+// then by name, ignoring case.
+// Artwork paths in those gamelists are relative to the gamelist, and are copied and resized like any download.
+// A system's gamelist is read and indexed the first time it is searched, so every search after that is a lookup.
+void local_generate_scraper_requests(const ScraperSearchParams& params, std::queue< std::unique_ptr<ScraperRequest> >& requests,
+	std::vector<ScraperSearchResult>& results);
+
+#endif // ES_APP_SCRAPERS_LOCAL_SCRAPER_H
@@ -0,0 +1,379 @@
+#include "scrapers/RomHasher.h"
+#include "Checksum.h"
+#include "Log.h"
+#include "platform.h"
+#include "Settings.h"
+#include <algorithm>
+#include <sstream>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+RomHasher* RomHasher::sInstance = NULL;
+
+namespace
+{
+	const size_t READ_BLOCK_SIZE = 1024 * 1024;
+
+	// joins the worker threads before the statics they use go away
+	struct WorkerStopper
+	{
+		~WorkerStopper()
+		{
+			RomHasher::shutdown();
+		}
+	} sWorkerStopper;
+
+	inline unsigned int readU16(const unsigned char* data)
+	{
+		return data[0] | (data[1] << 8);
+	}
+
+	inline unsigned int readU32(const unsigned char* data)
+	{
+		return data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
+	}
+
+	// Fills hash from the zip's central directory if it holds exactly one file. Returns false for anything else,
+	// including zip64 and archives of several files (MAME sets), which are then hashed as they are.
+	bool readSingleFileZip(const std::string& path, RomHash& hash)
+	{
+		std::ifstream file(path, std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+		if(!file.is_open())
+			return false;
+
+		// the end of central directory record is in the last 22 bytes, plus a comment of up to 64k
+		const long long fileSize = file.tellg();
+		const long long tailSize = std::min(fileSize, 22LL + 0xFFFF);
+		std::vector<unsigned char> tail((size_t)tailSize);
+		file.seekg(fileSize - tailSize);
+		if(tail.size() < 22 || !file.read((char*)tail.data(), tail.size()))
+			return false;
+
+		const unsigned char* end = NULL;
+		for(size_t i = tail.size() - 22 + 1; i-- > 0;)
+		{
+			if(readU32(&tail[i]) == 0x06054b50)
+			{
+				end = &tail[i];
+				break;
+			}
+		}
+
+		if(end == NULL)
+			return false;
+
+		const unsigned int directorySize = readU32(end + 12);
+		const unsigned int directoryOffset = readU32(end + 16);
+		if(directoryOffset == 0xFFFFFFFF || (long long)directoryOffset + directorySize > fileSize)
+			return false;
+
+		std::vector<unsigned char> directory(directorySize);
+		file.seekg(directoryOffset);
+		if(!file.read((char*)directory.data(), directory.size()))
+			return false;
+
+		int files = 0;
+		for(size_t pos = 0; pos + 46 <= directory.size();)
+		{
+			const unsigned char* header = &directory[pos];
+			if(readU32(header) != 0x02014b50)
+				return false;
+
+			const unsigned int nameLength = readU16(header + 28);
+			const size_t headerSize = 46 + nameLength + readU16(header + 30) + readU16(header + 32);
+			if(pos + headerSize > directory.size())
+				return false;
+
+			// directories are entries too
+			if(nameLength == 0 || header[46 + nameLength - 1] != '/')
+			{
+				if(++files > 1)
+					return false;
+
+				const unsigned int size = readU32(header + 24);
+				if(size == 0xFFFFFFFF)
+					return false;
+
+				hash.crc32 = Crc32::toHex(readU32(header + 16));
+				hash.size = size;
+			}
+
+			pos += headerSize;
+		}
+
+		return files == 1;
+	}
+
+	// the Digest flags a hash has, a ROM inside a zip only ever has its CRC32
+	unsigned int digestsIn(const RomHash& hash)
+	{
+		if(hash.empty())
+			return 0;
+
+		return RomHasher::CRC32 | (hash.md5.empty() ? 0 : RomHasher::MD5) | (hash.sha1.empty() ? 0 : RomHasher::SHA1);
+	}
+}
+
+RomHasher* RomHasher::getInstance()
+{
+	if(sInstance == NULL)
+		sInstance = new RomHasher();
+
+	return sInstance;
+}
+
+void RomHasher::shutdown()
+{
+	if(sInstance != NULL)
+		sInstance->stopWorkers();
+}
+
+RomHasher::RomHasher() : mStopping(false)
+{
+	mCachePath = getHomePath() + "/.emulationstation/rom_hashes.txt";
+	loadCache();
+}
+
+void RomHasher::loadCache()
+{
+	size_t lines = 0;
+	{
+		std::ifstream file(mCachePath);
+		std::string line;
+		while(std::getline(file, line))
+		{
+			// size, modification time, crc32, md5, sha1, hashed size, then the path so it can have tabs in it
+			std::istringstream stream(line);
+			Entry entry;
+			std::string path;
+			if(!(stream >> entry.fileSize >> entry.modified) || !std::getline(stream.ignore(), entry.hash.crc32, '\t') ||
+				!std::getline(stream, entry.hash.md5, '\t') || !std::getline(stream, entry.hash.sha1, '\t') ||
+				!(stream >> entry.hash.size) || !std::getline(stream.ignore(), path) || path.empty())
+				continue;
+
+			entry.checked = false;
+			entry.done = true;
+			entry.digests = digestsIn(entry.hash);
+			mEntries[path] = entry;
+			lines++;
+		}
+	}
+
+	// files that were rehashed leave their old lines behind, write out only the current ones once that's most of them
+	const bool compact = lines > mEntries.size() * 2;
+	mCacheFile.open(mCachePath, compact ? std::ios_base::out | std::ios_base::trunc : std::ios_base::out | std::ios_base::app);
+	if(!mCacheFile.is_open())
+	{
+		LOG(LogWarning) << "Could not open \"" << mCachePath << "\", ROM hashes won't be kept";
+		return;
+	}
+
+	if(compact)
+	{
+		for(auto it = mEntries.cbegin(); it != mEntries.cend(); it++)
+		{
+			const RomHash& hash = it->second.hash;
+			mCacheFile << it->second.fileSize << "\t" << (long long)it->second.modified << "\t" << hash.crc32 << "\t" << hash.md5 << "\t" <<
+				hash.sha1 << "\t" << hash.size << "\t" << it->first << "\n";
+		}
+		mCacheFile.flush();
+	}
+}
+
+void RomHasher::startWorkers()
+{
+	unsigned int count = (unsigned int)std::max(Settings::getInstance()->getInt("RomHashThreads"), 0);
+	if(count == 0)
+		count = std::max(1u, std::thread::hardware_concurrency());
+
+	for(unsigned int i = 0; i < count; i++)
+		mWorkers.push_back(std::thread(&RomHasher::runWorker, this));
+}
+
+void RomHasher::stopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+
+	mQueueChanged.notify_all();
+	for(auto it = mWorkers.begin(); it != mWorkers.end(); it++)
+		it->join();
+	mWorkers.clear();
+}
+
+void RomHasher::request(const std::string& path, unsigned int digests)
+{
+	// the file is looked at by the worker threads, this is called for every ROM of a batch at once
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	digests |= CRC32;
+
+	auto it = mEntries.find(path);
+	if(it != mEntries.end())
+	{
+		Entry& entry = it->second;
+		if(entry.checked && entry.done && (entry.digests & digests) == digests)
+			return;
+
+		// a different scraper wants more, have it all computed in one go
+		entry.digests |= digests;
+
+		// still queued, or the worker checking it queues it again when it's done
+		if(!entry.done)
+			return;
+
+		entry.done = false;
+	}else{
+		Entry& entry = mEntries[path];
+		entry.fileSize = 0;
+		entry.modified = 0;
+		entry.checked = false;
+		entry.done = false;
+		entry.digests = digests;
+	}
+
+	if(mStopping)
+		return;
+
+	mQueue.push_back(path);
+
+	if(mWorkers.empty())
+		startWorkers();
+	mQueueChanged.notify_one();
+}
+
+bool RomHasher::get(const std::string& path, unsigned int digests, RomHash& hash)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		auto it = mEntries.find(path);
+		if(it != mEntries.cend() && it->second.checked && it->second.done && (it->second.digests & (digests | CRC32)) == (digests | CRC32))
+		{
+			hash = it->second.hash;
+			return true;
+		}
+	}
+
+	request(path, digests);
+	return false;
+}
+
+void RomHasher::runWorker()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	while(true)
+	{
+		mQueueChanged.wait(lock, [this] { return mStopping || !mQueue.empty(); });
+		if(mStopping)
+			return;
+
+		const std::string path = mQueue.front();
+		mQueue.pop_front();
+
+		const Entry queued = mEntries[path];
+
+		lock.unlock();
+
+		boost::system::error_code ec;
+		const bool regularFile = fs::is_regular_file(path, ec);
+		const unsigned long long fileSize = regularFile ? fs::file_size(path, ec) : 0;
+		const time_t modified = regularFile ? fs::last_write_time(path, ec) : 0;
+
+		// a folder, or gone - there's nothing to hash; a hash we have is good for as long as the file doesn't change
+		RomHash hash;
+		bool hashed = false;
+		if(regularFile && !ec)
+		{
+			if(fileSize == queued.fileSize && modified == queued.modified && (digestsIn(queued.hash) & queued.digests) == queued.digests)
+			{
+				hash = queued.hash;
+			}else{
+				hash = hashFile(path, queued.digests);
+				hashed = true;
+			}
+		}
+
+		lock.lock();
+
+		if(mStopping)
+			return;
+
+		// more digests were asked for in the meantime
+		Entry& entry = mEntries[path];
+		if(entry.digests != queued.digests)
+		{
+			mQueue.push_front(path);
+			continue;
+		}
+
+		entry.fileSize = fileSize;
+		entry.modified = modified;
+		entry.checked = true;
+		entry.done = true;
+		entry.hash = hash;
+
+		if(hashed && mCacheFile.is_open() && !hash.empty())
+		{
+			mCacheFile << entry.fileSize << "\t" << (long long)entry.modified << "\t" << hash.crc32 << "\t" << hash.md5 << "\t" <<
+				hash.sha1 << "\t" << hash.size << "\t" << path << std::endl;
+		}
+	}
+}
+
+RomHash RomHasher::hashFile(const std::string& path, unsigned int digests) const
+{
+	std::string extension = fs::path(path).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	if(extension == ".zip")
+	{
+		RomHash inner;
+		if(readSingleFileZip(path, inner))
+			return inner;
+	}
+
+	std::ifstream file(path, std::ios_base::in | std::ios_base::binary);
+	if(!file.is_open())
+	{
+		LOG(LogWarning) << "Could not open \"" << path << "\" to hash it";
+		return RomHash();
+	}
+
+	RomHash hash;
+	Crc32 crc32;
+	Md5 md5;
+	Sha1 sha1;
+
+	std::vector<char> block(READ_BLOCK_SIZE);
+	while(!mStopping)
+	{
+		file.read(block.data(), block.size());
+		const size_t length = (size_t)file.gcount();
+		if(length == 0)
+			break;
+
+		crc32.update(block.data(), length);
+		if(digests & MD5)
+			md5.update(block.data(), length);
+		if(digests & SHA1)
+			sha1.update(block.data(), length);
+		hash.size += length;
+	}
+
+	if(file.bad() || mStopping)
+	{
+		if(!mStopping)
+			LOG(LogWarning) << "Error reading \"" << path << "\" to hash it";
+		return RomHash();
+	}
+
+	hash.crc32 = crc32.finish();
+	if(digests & MD5)
+		hash.md5 = md5.finish();
+	if(digests & SHA1)
+		hash.sha1 = sha1.finish();
+	return hash;
+}
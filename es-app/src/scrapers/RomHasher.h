@@ -0,0 +1,86 @@
+#pragma once
+#ifndef ES_APP_SCRAPERS_ROM_HASHER_H
+#define ES_APP_SCRAPERS_ROM_HASHER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct RomHash
+{
+	RomHash() : size(0) {}
+
+	// lowercase hex, all empty if the file couldn't be read
+	std::string crc32;
+	std::string md5; // empty if it wasn't asked for, or for a ROM inside a zip, which would have to be unpacked
+	std::string sha1; // same
+	unsigned long long size; // of what was hashed
+
+	inline bool empty() const { return crc32.empty(); }
+};
+
+//This is a singleton that checksums ROMs on worker threads so scrapers can look games up by hash instead of by name.
+//Files are read a block at a time, so disc images of any size are fine. A zip with a single file in it is identified by
+//that file, whose CRC32 is read from the zip's directory without unpacking anything.
+//Hashes are kept in ~/.emulationstation/rom_hashes.txt, and used for as long as the file's size and modification time don't change.
+//Settings "RomHashThreads" is how many files are hashed at once, 0 for one per core.
+class RomHasher
+{
+public:
+	// which checksums to compute, the CRC32 is always there
+	enum Digest
+	{
+		CRC32 = 1,
+		MD5 = 2,
+		SHA1 = 4
+	};
+
+	static RomHasher* getInstance();
+	static void shutdown(); // stops the worker threads, dropping whatever they are hashing
+
+	// Queues path to be hashed unless it already is, or its hash is known, with at least the Digest flags in digests.
+	// Call it as early as possible. It only takes a lock, whether a known hash still matches the file is checked by the workers.
+	void request(const std::string& path, unsigned int digests);
+	// Returns false until path has been hashed with digests, calling request() if nobody has yet.
+	bool get(const std::string& path, unsigned int digests, RomHash& hash);
+
+private:
+	static RomHasher* sInstance;
+
+	RomHasher();
+
+	struct Entry
+	{
+		unsigned long long fileSize;
+		time_t modified;
+		bool checked; // against the file by a worker, entries loaded from rom_hashes.txt aren't until they are asked for
+		bool done; // not queued or being worked on
+		unsigned int digests; // in hash, or wanted while not done
+		RomHash hash;
+	};
+
+	void loadCache();
+	void startWorkers();
+	void stopWorkers();
+	void runWorker();
+	RomHash hashFile(const std::string& path, unsigned int digests) const; // runs on the worker threads
+
+	std::mutex mMutex;
+	std::condition_variable mQueueChanged;
+	std::unordered_map<std::string, Entry> mEntries; // by path
+	std::deque<std::string> mQueue;
+	std::vector<std::thread> mWorkers;
+	std::atomic<bool> mStopping; // also checked between blocks while hashing
+
+	std::string mCachePath;
+	std::ofstream mCacheFile; // every new hash is appended, the last line for a path wins
+};
+
+#endif // ES_APP_SCRAPERS_ROM_HASHER_H
@@ -1,19 +1,33 @@
 #include "scrapers/Scraper.h"
 #include "scrapers/GamesDBJSONScraper.h"
+#include "scrapers/LocalScraper.h"
 #include "scrapers/ScreenScraper.h"
 #include "Log.h"
 #include "Settings.h"
 #include <FreeImage.h>
+#include <chrono>
+#include <fstream>
 #include <boost/filesystem.hpp>
 
 const std::map<std::string, generate_scraper_requests_func> scraper_request_funcs = {
 	{ "TheGamesDB", &thegamesdb_generate_json_scraper_requests },
-	{ "ScreenScraper", &screenscraper_generate_scraper_requests }
+	{ "ScreenScraper", &screenscraper_generate_scraper_requests },
+	{ "Local", &local_generate_scraper_requests }
 };
 
-std::unique_ptr<ScraperSearchHandle> startScraperSearch(const ScraperSearchParams& params)
+// the ones that get ScraperSearchParams::romHash filled in, with the digests they use
+const std::map<std::string, unsigned int> scrapers_using_rom_hashes = {
+	{ "ScreenScraper", RomHasher::CRC32 | RomHasher::MD5 | RomHasher::SHA1 },
+	{ "Local", RomHasher::CRC32 }
+};
+
+// a search doesn't wait longer than this for its ROM to be hashed, and goes by name instead
+// (the hash is still finished and kept for next time)
+#define ROM_HASH_TIMEOUT_MS 5000
+
+std::unique_ptr<ScraperSearchHandle> startScraperSearch(const ScraperSearchParams& params, const std::string& scraper)
 {
-	const std::string& name = Settings::getInstance()->getString("Scraper");
+	const std::string& name = scraper.empty() ? Settings::getInstance()->getString("Scraper") : scraper;
 	std::unique_ptr<ScraperSearchHandle> handle(new ScraperSearchHandle());
 
 	// Check if the Scraper in the settings still exists as a registered scraping source.
@@ -21,6 +35,15 @@ std::unique_ptr<ScraperSearchHandle> startScraperSearch(const ScraperSearchParam
 	{
 		LOG(LogWarning) << "Configured scraper (" << name << ") unavailable, scraping aborted.";
 	}
+	else if (scrapers_using_rom_hashes.find(name) != scrapers_using_rom_hashes.end())
+	{
+		// generated in update(), once the hash is known
+		handle->mParams = params;
+		handle->mGenerateRequests = scraper_request_funcs.at(name);
+		handle->mDigests = scrapers_using_rom_hashes.at(name);
+		handle->mHashDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ROM_HASH_TIMEOUT_MS);
+		RomHasher::getInstance()->request(params.game->getPath().string(), handle->mDigests);
+	}
 	else
 	{
 		scraper_request_funcs.at(name)(params, handle->mRequestQueue, handle->mResults);
@@ -29,6 +52,13 @@ std::unique_ptr<ScraperSearchHandle> startScraperSearch(const ScraperSearchParam
 	return handle;
 }
 
+void prefetchScraperSearch(const ScraperSearchParams& params, const std::string& scraper)
+{
+	auto it = scrapers_using_rom_hashes.find(scraper.empty() ? Settings::getInstance()->getString("Scraper") : scraper);
+	if(it != scrapers_using_rom_hashes.end())
+		RomHasher::getInstance()->request(params.game->getPath().string(), it->second);
+}
+
 std::vector<std::string> getScraperList()
 {
 	std::vector<std::string> list;
@@ -46,8 +76,14 @@ bool isValidConfiguredScraper()
 	return scraper_request_funcs.find(name) != scraper_request_funcs.end();
 }
 
+std::string getScraperBaseUrl(const std::string& defaultUrl)
+{
+	const std::string& url = Settings::getInstance()->getString("ScraperUrl");
+	return url.empty() ? defaultUrl : url;
+}
+
 // ScraperSearchHandle
-ScraperSearchHandle::ScraperSearchHandle()
+ScraperSearchHandle::ScraperSearchHandle() : mGenerateRequests(NULL), mDigests(0)
 {
 	setStatus(ASYNC_IN_PROGRESS);
 }
@@ -57,6 +93,20 @@ void ScraperSearchHandle::update()
 	if(mStatus == ASYNC_DONE)
 		return;
 
+	if(mGenerateRequests)
+	{
+		if(!RomHasher::getInstance()->get(mParams.game->getPath().string(), mDigests, mParams.romHash))
+		{
+			if(std::chrono::steady_clock::now() < mHashDeadline)
+				return;
+
+			LOG(LogInfo) << "Hashing \"" << mParams.game->getPath().string() << "\" is taking too long, searching by name";
+		}
+
+		mGenerateRequests(mParams, mRequestQueue, mResults);
+		mGenerateRequests = NULL;
+	}
+
 	if(!mRequestQueue.empty())
 	{
 		// a request can add more requests to the queue while running,
@@ -197,12 +247,42 @@ std::unique_ptr<ImageDownloadHandle> downloadImageAsync(const std::string& url,
 }
 
 ImageDownloadHandle::ImageDownloadHandle(const std::string& url, const std::string& path, int maxWidth, int maxHeight) :
-	mSavePath(path), mMaxWidth(maxWidth), mMaxHeight(maxHeight), mReq(new HttpReq(url))
+	mSavePath(path), mMaxWidth(maxWidth), mMaxHeight(maxHeight), mProcessed(false)
+{
+	// with nothing to resize, the download can go straight to disk
+	if(mMaxWidth == 0 && mMaxHeight == 0)
+		mReq = std::unique_ptr<HttpReq>(new HttpReq(url, mSavePath));
+	else
+		mReq = std::unique_ptr<HttpReq>(new HttpReq(url));
+}
+
+ImageDownloadHandle::~ImageDownloadHandle()
 {
+	if(mThread.joinable())
+		mThread.join();
 }
 
 void ImageDownloadHandle::update()
 {
+	if(mStatus != ASYNC_IN_PROGRESS)
+		return;
+
+	// saving on mThread
+	if(mThread.joinable())
+	{
+		if(!mProcessed)
+			return;
+
+		mThread.join();
+
+		if(!mProcessError.empty())
+			setError(mProcessError);
+		else
+			setStatus(ASYNC_DONE);
+
+		return;
+	}
+
 	if(mReq->status() == HttpReq::REQ_IN_PROGRESS)
 		return;
 
@@ -214,59 +294,95 @@ void ImageDownloadHandle::update()
 		return;
 	}
 
-	// download is done, save it to disk
-	std::ofstream stream(mSavePath, std::ios_base::out | std::ios_base::binary);
-	if(stream.bad())
+	// already saved
+	if(mMaxWidth == 0 && mMaxHeight == 0)
 	{
-		setError("Failed to open image path to write. Permission error? Disk full?");
+		mReq.reset();
+		setStatus(ASYNC_DONE);
 		return;
 	}
 
-	const std::string& content = mReq->getContent();
-	stream.write(content.data(), content.length());
-	stream.close();
-	if(stream.bad())
-	{
-		setError("Failed to save image. Disk full?");
-		return;
-	}
+	// download is done, decode, resize and save it without holding up the UI
+	mContent = mReq->takeContent();
+	mReq.reset();
+	mThread = std::thread(&ImageDownloadHandle::process, this);
+}
+
+void ImageDownloadHandle::process()
+{
+	if(!resizeImage(mContent, mSavePath, mMaxWidth, mMaxHeight))
+		mProcessError = "Error saving image. Out of memory? Disk full?";
+
+	mContent.clear();
+	mProcessed = true;
+}
 
-	// resize it
-	if(!resizeImage(mSavePath, mMaxWidth, mMaxHeight))
+namespace
+{
+	bool saveFile(const std::string& data, const std::string& path)
 	{
-		setError("Error saving resized image. Out of memory? Disk full?");
-		return;
-	}
+		std::ofstream stream(path, std::ios_base::out | std::ios_base::binary);
+		if(!stream.is_open())
+		{
+			LOG(LogError) << "Failed to open image path \"" << path << "\" to write. Permission error?";
+			return false;
+		}
 
-	setStatus(ASYNC_DONE);
+		stream.write(data.data(), data.length());
+		stream.close();
+		if(stream.bad())
+		{
+			LOG(LogError) << "Failed to save image \"" << path << "\". Disk full?";
+			return false;
+		}
+
+		return true;
+	}
 }
 
 //you can pass 0 for width or height to keep aspect ratio
-bool resizeImage(const std::string& path, int maxWidth, int maxHeight)
+bool resizeImage(const std::string& data, const std::string& path, int maxWidth, int maxHeight)
 {
-	// nothing to do
+	// nothing to resize, the downloaded file is what we want
 	if(maxWidth == 0 && maxHeight == 0)
-		return true;
+		return saveFile(data, path);
 
 	FREE_IMAGE_FORMAT format = FIF_UNKNOWN;
 	FIBITMAP* image = NULL;
 
+	FIMEMORY* memory = FreeImage_OpenMemory((BYTE*)data.data(), (DWORD)data.length());
+	if(memory == NULL)
+	{
+		LOG(LogError) << "Error - could not open image data for \"" << path << "\"!";
+		return false;
+	}
+
 	//detect the filetype
-	format = FreeImage_GetFileType(path.c_str(), 0);
+	format = FreeImage_GetFileTypeFromMemory(memory, 0);
 	if(format == FIF_UNKNOWN)
 		format = FreeImage_GetFIFFromFilename(path.c_str());
 	if(format == FIF_UNKNOWN)
 	{
 		LOG(LogError) << "Error - could not detect filetype for image \"" << path << "\"!";
+		FreeImage_CloseMemory(memory);
 		return false;
 	}
 
 	//make sure we can read this filetype first, then load it
 	if(FreeImage_FIFSupportsReading(format))
 	{
-		image = FreeImage_Load(format, path.c_str());
+		image = FreeImage_LoadFromMemory(format, memory);
 	}else{
 		LOG(LogError) << "Error - file format reading not supported for image \"" << path << "\"!";
+		FreeImage_CloseMemory(memory);
+		return false;
+	}
+
+	FreeImage_CloseMemory(memory);
+
+	if(image == NULL)
+	{
+		LOG(LogError) << "Error - could not decode image \"" << path << "\"!";
 		return false;
 	}
 
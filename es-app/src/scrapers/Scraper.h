@@ -6,6 +6,10 @@
 #include "SystemData.h"
 #include "HttpReq.h"
 #include "AsyncHandle.h"
+#include "scrapers/RomHasher.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <vector>
 #include <functional>
 #include <queue>
@@ -18,6 +22,8 @@ struct ScraperSearchParams
 	FileData* game;
 
 	std::string nameOverride;
+
+	RomHash romHash; // filled in before the requests are generated for scrapers that look games up by checksum, empty if that took too long
 };
 
 struct ScraperSearchResult
@@ -59,6 +65,9 @@ struct ScraperSearchResult
 // ScraperHttpRequest - implementation of ScraperRequest that waits on an HttpReq, then processes it with some processing function.
 
 
+class ScraperRequest;
+typedef void (*generate_scraper_requests_func)(const ScraperSearchParams& params, std::queue< std::unique_ptr<ScraperRequest> >& requests, std::vector<ScraperSearchResult>& results);
+
 // a scraper search gathers results from (potentially multiple) ScraperRequests
 class ScraperRequest : public AsyncHandle
 {
@@ -97,14 +106,23 @@ public:
 	inline const std::vector<ScraperSearchResult>& getResults() const { assert(mStatus != ASYNC_IN_PROGRESS); return mResults; }
 
 protected:
-	friend std::unique_ptr<ScraperSearchHandle> startScraperSearch(const ScraperSearchParams& params);
+	friend std::unique_ptr<ScraperSearchHandle> startScraperSearch(const ScraperSearchParams& params, const std::string& scraper);
 
 	std::queue< std::unique_ptr<ScraperRequest> > mRequestQueue;
 	std::vector<ScraperSearchResult> mResults;
+
+	// set while the ROM is being hashed, the requests are generated once it's done or mHashDeadline has passed
+	ScraperSearchParams mParams;
+	generate_scraper_requests_func mGenerateRequests;
+	unsigned int mDigests; // RomHasher::Digest flags the scraper uses
+	std::chrono::steady_clock::time_point mHashDeadline;
 };
 
-// will use the current scraper settings to pick the result source
-std::unique_ptr<ScraperSearchHandle> startScraperSearch(const ScraperSearchParams& params);
+// will use the current scraper settings to pick the result source, or the scraper named by scraper if it isn't empty
+std::unique_ptr<ScraperSearchHandle> startScraperSearch(const ScraperSearchParams& params, const std::string& scraper = "");
+
+// starts hashing the game's ROM ahead of its search if the scraper (as above) looks games up by checksum
+void prefetchScraperSearch(const ScraperSearchParams& params, const std::string& scraper = "");
 
 // returns a list of valid scraper names
 std::vector<std::string> getScraperList();
@@ -112,7 +130,8 @@ std::vector<std::string> getScraperList();
 // returns true if the scraper configured in the settings is still valid
 bool isValidConfiguredScraper();
 
-typedef void (*generate_scraper_requests_func)(const ScraperSearchParams& params, std::queue< std::unique_ptr<ScraperRequest> >& requests, std::vector<ScraperSearchResult>& results);
+// returns Settings::getString("ScraperUrl") if it is set, otherwise defaultUrl
+std::string getScraperBaseUrl(const std::string& defaultUrl);
 
 // -------------------------------------------------------------------------
 
@@ -134,18 +153,27 @@ private:
 	std::vector<ResolvePair> mFuncs;
 };
 
+// Downloads an image, then decodes, resizes and saves it on a thread of its own so the UI doesn't stall.
 class ImageDownloadHandle : public AsyncHandle
 {
 public:
 	ImageDownloadHandle(const std::string& url, const std::string& path, int maxWidth, int maxHeight);
+	virtual ~ImageDownloadHandle();
 
 	void update() override;
 
 private:
+	void process(); // runs on mThread
+
 	std::unique_ptr<HttpReq> mReq;
 	std::string mSavePath;
 	int mMaxWidth;
 	int mMaxHeight;
+
+	std::thread mThread;
+	std::string mContent; // the downloaded image, only touched by mThread while it runs
+	std::string mProcessError; // set by mThread, empty if the image was saved
+	std::atomic<bool> mProcessed;
 };
 
 //About the same as "~/.emulationstation/downloaded_images/[system_name]/[game_name].[url's extension]".
@@ -158,9 +186,10 @@ std::unique_ptr<ImageDownloadHandle> downloadImageAsync(const std::string& url,
 // Resolves all metadata assets that need to be downloaded.
 std::unique_ptr<MDResolveHandle> resolveMetaDataAssets(const ScraperSearchResult& result, const ScraperSearchParams& search);
 
-//You can pass 0 for maxWidth or maxHeight to automatically keep the aspect ratio.
-//Will overwrite the image at [path] with the new resized one.
-//Returns true if successful, false otherwise.
-bool resizeImage(const std::string& path, int maxWidth, int maxHeight);
+//Decodes the image file held in [data], resizes it and saves it to [path] in the same format, without going through the disk first.
+//You can pass 0 for maxWidth or maxHeight to automatically keep the aspect ratio, or both to save [data] unchanged.
+//Will overwrite the image at [path].
+//Returns true if successful, false otherwise. Safe to call from any thread.
+bool resizeImage(const std::string& data, const std::string& path, int maxWidth, int maxHeight);
 
 #endif // ES_APP_SCRAPERS_SCRAPER_H
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "scrapers/ScraperBatch.h"
+#include "Log.h"
+#include "Settings.h"
+#include <algorithm>
+
+ScraperBatch::ScraperBatch(const std::queue<ScraperSearchParams>& searches, const std::string& scraper, int maxSearches, int maxDownloads) :
+	mSearchQueue(searches), mScraper(scraper), mSearching(0), mDownloading(0)
+{
+	mMaxSearches = std::max(maxSearches > 0 ? maxSearches : Settings::getInstance()->getInt("ScraperMaxSearches"), 1);
+	mMaxDownloads = std::max(maxDownloads > 0 ? maxDownloads : Settings::getInstance()->getInt("ScraperMaxDownloads"), 1);
+
+	HttpReq::setMaxRequestsPerSecond(Settings::getInstance()->getInt("ScraperRequestsPerSecond"));
+
+	// ROMs get hashed in the order they'll be searched, well before their turn comes
+	for(std::queue<ScraperSearchParams> queue = searches; !queue.empty(); queue.pop())
+		prefetchScraperSearch(queue.front(), mScraper);
+}
+
+ScraperBatch::~ScraperBatch()
+{
+	HttpReq::setMaxRequestsPerSecond(0);
+}
+
+void ScraperBatch::startSearch()
+{
+	std::unique_ptr<Job> job(new Job());
+	job->params = mSearchQueue.front();
+	job->state = SEARCHING;
+	job->search = startScraperSearch(job->params, mScraper);
+	mSearchQueue.pop();
+
+	mJobs.push_back(std::move(job));
+	mSearching++;
+}
+
+void ScraperBatch::updateJob(Job& job)
+{
+	if(job.state == SEARCHING)
+	{
+		AsyncHandleStatus status = job.search->status();
+		if(status == ASYNC_IN_PROGRESS)
+			return;
+
+		mSearching--;
+
+		if(status == ASYNC_ERROR)
+		{
+			LOG(LogWarning) << "Scraping \"" << job.params.game->getPath().string() << "\" failed: " << job.search->getStatusString();
+			job.state = SKIPPED;
+		}else if(job.search->getResults().empty())
+		{
+			job.state = SKIPPED;
+		}else{
+			job.result = job.search->getResults().front();
+			job.state = job.result.imageUrl.empty() ? ACCEPTED : WAITING_FOR_DOWNLOAD;
+		}
+
+		job.search.reset();
+	}
+
+	if(job.state == WAITING_FOR_DOWNLOAD && mDownloading < mMaxDownloads)
+	{
+		job.resolve = resolveMetaDataAssets(job.result, job.params);
+		job.state = DOWNLOADING;
+		mDownloading++;
+	}
+
+	if(job.state == DOWNLOADING)
+	{
+		AsyncHandleStatus status = job.resolve->status();
+		if(status == ASYNC_IN_PROGRESS)
+			return;
+
+		mDownloading--;
+
+		if(status == ASYNC_ERROR)
+		{
+			LOG(LogWarning) << "Downloading media for \"" << job.params.game->getPath().string() << "\" failed: " << job.resolve->getStatusString();
+			job.state = SKIPPED;
+		}else{
+			job.result = job.resolve->getResult();
+			job.state = ACCEPTED;
+		}
+
+		job.resolve.reset();
+	}
+}
+
+void ScraperBatch::update()
+{
+	// oldest first, so they get the free download slots
+	for(auto it = mJobs.begin(); it != mJobs.end(); it++)
+		updateJob(**it);
+
+	// finished games wait for everything before them, so don't let them pile up behind a slow one
+	const unsigned int maxJobs = (mMaxSearches + mMaxDownloads) * 2;
+	while(!mSearchQueue.empty() && mSearching < mMaxSearches && mJobs.size() < maxJobs)
+		startSearch();
+
+	while(!mJobs.empty() && (mJobs.front()->state == ACCEPTED || mJobs.front()->state == SKIPPED))
+	{
+		std::unique_ptr<Job> job = std::move(mJobs.front());
+		mJobs.pop_front();
+
+		if(job->state == ACCEPTED)
+		{
+			if(mAcceptCallback)
+				mAcceptCallback(job->params, job->result);
+		}else{
+			if(mSkipCallback)
+				mSkipCallback(job->params);
+		}
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#ifndef ES_APP_SCRAPERS_SCRAPER_BATCH_H
+#define ES_APP_SCRAPERS_SCRAPER_BATCH_H
+
+#include "scrapers/Scraper.h"
+#include <deque>
+#include <functional>
+#include <memory>
+#include <queue>
+
+// Scrapes a list of games without asking about any of them, always taking the first result.
+// Several searches and asset downloads are kept in flight at once (Settings "ScraperMaxSearches" and "ScraperMaxDownloads"),
+// requests to each host are spaced out by HttpReq (Settings "ScraperRequestsPerSecond"), and results are still handed to
+// the callbacks one at a time in the order the searches were given, so nothing is applied out of order.
+class ScraperBatch
+{
+public:
+	// scraper, maxSearches and maxDownloads replace the scraper and limits from the settings unless they're empty or 0
+	ScraperBatch(const std::queue<ScraperSearchParams>& searches, const std::string& scraper = "", int maxSearches = 0, int maxDownloads = 0);
+	~ScraperBatch();
+
+	// Called from update() with the game's metadata assets already downloaded.
+	inline void setAcceptCallback(const std::function<void(const ScraperSearchParams&, const ScraperSearchResult&)>& acceptCallback) { mAcceptCallback = acceptCallback; }
+	// Called from update() for games with no results or whose search failed.
+	inline void setSkipCallback(const std::function<void(const ScraperSearchParams&)>& skipCallback) { mSkipCallback = skipCallback; }
+
+	// Polls the searches in flight, starts new ones and calls the callbacks for every finished game at the front of the queue.
+	void update();
+
+	inline bool isDone() const { return mJobs.empty() && mSearchQueue.empty(); }
+	inline const ScraperSearchParams* getOldestPending() const { return mJobs.empty() ? NULL : &mJobs.front()->params; }
+
+private:
+	enum JobState
+	{
+		SEARCHING,
+		WAITING_FOR_DOWNLOAD,
+		DOWNLOADING,
+		ACCEPTED,
+		SKIPPED
+	};
+
+	struct Job
+	{
+		ScraperSearchParams params;
+		JobState state;
+		std::unique_ptr<ScraperSearchHandle> search;
+		std::unique_ptr<MDResolveHandle> resolve;
+		ScraperSearchResult result;
+	};
+
+	void startSearch();
+	void updateJob(Job& job);
+
+	std::queue<ScraperSearchParams> mSearchQueue; // not started yet
+	std::deque< std::unique_ptr<Job> > mJobs; // started, in the order they were given
+
+	std::string mScraper;
+	unsigned int mMaxSearches;
+	unsigned int mMaxDownloads;
+	unsigned int mSearching;
+	unsigned int mDownloading;
+
+	std::function<void(const ScraperSearchParams&, const ScraperSearchResult&)> mAcceptCallback;
+	std::function<void(const ScraperSearchParams&)> mSkipCallback;
+};
+
+#endif // ES_APP_SCRAPERS_SCRAPER_BATCH_H
@@ -125,6 +125,18 @@ void screenscraper_generate_scraper_requests(const ScraperSearchParams& params,
 	ScreenScraperRequest::ScreenScraperConfig ssConfig;
 
 	path = ssConfig.getGameSearchUrl(params.game->getCleanName());
+
+	// matches by checksum are exact, the name is only used if they don't find anything
+	const RomHash& hash = params.romHash;
+	if (!hash.empty())
+	{
+		path += "&romtype=rom&crc=" + hash.crc32 + "&romtaille=" + std::to_string(hash.size);
+		if (!hash.md5.empty())
+			path += "&md5=" + hash.md5;
+		if (!hash.sha1.empty())
+			path += "&sha1=" + hash.sha1;
+	}
+
 	auto& platforms = params.system->getPlatformIds();
 
 	for (auto platformIt = platforms.cbegin(); platformIt != platforms.cend(); platformIt++)
@@ -149,7 +161,8 @@ void ScreenScraperRequest::process(const std::unique_ptr<HttpReq>& req, std::vec
 	assert(req->status() == HttpReq::REQ_SUCCESS);
 
 	pugi::xml_document doc;
-	pugi::xml_parse_result parseResult = doc.load(req->getContent().c_str());
+	const std::string& content = req->getContent();
+	pugi::xml_parse_result parseResult = doc.load_buffer(content.data(), content.size());
 
 	if (!parseResult)
 	{
@@ -324,7 +337,7 @@ void ScreenScraperRequest::processList(const pugi::xml_document& xmldoc, std::ve
 
 std::string ScreenScraperRequest::ScreenScraperConfig::getGameSearchUrl(const std::string gameName) const
 {
-	return API_URL_BASE
+	return getScraperBaseUrl(API_URL_BASE)
 		+ "/jeuInfos.php?devid=" + scramble(API_DEV_U, API_DEV_KEY)
 		+ "&devpassword=" + scramble(API_DEV_P, API_DEV_KEY)
 		+ "&softname=" + HttpReq::urlEncode(API_SOFT_NAME)
@@ -15,13 +15,16 @@ const int logoBuffersRight[] = { 1, 2, 5 };
 
 SystemView::SystemView(Window* window) : IList<SystemViewData, SystemData*>(window, LIST_SCROLL_STYLE_SLOW, LIST_ALWAYS_LOOP),
 										 mViewNeedsReload(true),
-										 mSystemInfo(window, "SYSTEM INFO", Font::get(FONT_SIZE_SMALL), 0x33333300, ALIGN_CENTER)
+										 mSystemInfo(window, "SYSTEM INFO", Font::get(FONT_SIZE_SMALL), 0x33333300, ALIGN_CENTER),
+										 mLoadingText(window, "", Font::get(FONT_SIZE_SMALL), 0x777777FF, ALIGN_CENTER), mLoadingTextCount(0)
 {
 	mCamOffset = 0;
 	mExtrasCamOffset = 0;
 	mExtrasFadeOpacity = 0.0f;
 
 	setSize((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
+	mLoadingText.setSize(mSize.x(), 0);
+	mLoadingText.setPosition(0, mSize.y() * 0.02f);
 	populate();
 }
 
@@ -30,88 +33,91 @@ void SystemView::populate()
 	mEntries.clear();
 
 	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
-	{
-		const std::shared_ptr<ThemeData>& theme = (*it)->getTheme();
+		addSystem(*it);
+}
 
-		if(mViewNeedsReload)
-			getViewElements(theme);
+void SystemView::addSystem(SystemData* system)
+{
+	const std::shared_ptr<ThemeData>& theme = system->getTheme();
 
-		Entry e;
-		e.name = (*it)->getName();
-		e.object = *it;
+	if(mViewNeedsReload)
+		getViewElements(theme);
 
-		// make logo
-		const ThemeData::ThemeElement* logoElem = theme->getElement("system", "logo", "image");
-		if(logoElem)
-		{
-			std::string path = logoElem->get<std::string>("path");
-			std::string defaultPath = logoElem->has("default") ? logoElem->get<std::string>("default") : "";
-			if((!path.empty() && ResourceManager::getInstance()->fileExists(path))
-			   || (!defaultPath.empty() && ResourceManager::getInstance()->fileExists(defaultPath)))
-			{
-				ImageComponent* logo = new ImageComponent(mWindow, false, false);
-				logo->setMaxSize(mCarousel.logoSize * mCarousel.logoScale);
-				logo->applyTheme(theme, "system", "logo", ThemeFlags::PATH | ThemeFlags::COLOR);
-				logo->setRotateByTargetSize(true);
-				e.data.logo = std::shared_ptr<GuiComponent>(logo);
-			}
-		}
-		if (!e.data.logo)
-		{
-			// no logo in theme; use text
-			TextComponent* text = new TextComponent(mWindow,
-				(*it)->getName(),
-				Font::get(FONT_SIZE_LARGE),
-				0x000000FF,
-				ALIGN_CENTER);
-			text->setSize(mCarousel.logoSize * mCarousel.logoScale);
-			text->applyTheme((*it)->getTheme(), "system", "logoText", ThemeFlags::FONT_PATH | ThemeFlags::FONT_SIZE | ThemeFlags::COLOR | ThemeFlags::FORCE_UPPERCASE);
-			e.data.logo = std::shared_ptr<GuiComponent>(text);
-
-			if (mCarousel.type == VERTICAL || mCarousel.type == VERTICAL_WHEEL){
-				text->setHorizontalAlignment(mCarousel.logoAlignment);
-				text->setVerticalAlignment(ALIGN_CENTER);
-			} else {
-				text->setHorizontalAlignment(ALIGN_CENTER);
-				text->setVerticalAlignment(mCarousel.logoAlignment);
-			}
-		}
+	Entry e;
+	e.name = system->getName();
+	e.object = system;
 
-		if (mCarousel.type == VERTICAL || mCarousel.type == VERTICAL_WHEEL)
+	// make logo
+	const ThemeData::ThemeElement* logoElem = theme->getElement("system", "logo", "image");
+	if(logoElem)
+	{
+		std::string path = logoElem->get<std::string>("path");
+		std::string defaultPath = logoElem->has("default") ? logoElem->get<std::string>("default") : "";
+		if((!path.empty() && ResourceManager::getInstance()->fileExists(path))
+		   || (!defaultPath.empty() && ResourceManager::getInstance()->fileExists(defaultPath)))
 		{
-			if (mCarousel.logoAlignment == ALIGN_LEFT)
-				e.data.logo->setOrigin(0, 0.5);
-			else if (mCarousel.logoAlignment == ALIGN_RIGHT)
-				e.data.logo->setOrigin(1.0, 0.5);
-			else
-				e.data.logo->setOrigin(0.5, 0.5);
+			ImageComponent* logo = new ImageComponent(mWindow, false, false);
+			logo->setMaxSize(mCarousel.logoSize * mCarousel.logoScale);
+			logo->applyTheme(theme, "system", "logo", ThemeFlags::PATH | ThemeFlags::COLOR);
+			logo->setRotateByTargetSize(true);
+			e.data.logo = std::shared_ptr<GuiComponent>(logo);
+		}
+	}
+	if (!e.data.logo)
+	{
+		// no logo in theme; use text
+		TextComponent* text = new TextComponent(mWindow,
+			system->getName(),
+			Font::get(FONT_SIZE_LARGE),
+			0x000000FF,
+			ALIGN_CENTER);
+		text->setSize(mCarousel.logoSize * mCarousel.logoScale);
+		text->applyTheme(system->getTheme(), "system", "logoText", ThemeFlags::FONT_PATH | ThemeFlags::FONT_SIZE | ThemeFlags::COLOR | ThemeFlags::FORCE_UPPERCASE);
+		e.data.logo = std::shared_ptr<GuiComponent>(text);
+
+		if (mCarousel.type == VERTICAL || mCarousel.type == VERTICAL_WHEEL){
+			text->setHorizontalAlignment(mCarousel.logoAlignment);
+			text->setVerticalAlignment(ALIGN_CENTER);
 		} else {
-			if (mCarousel.logoAlignment == ALIGN_TOP)
-				e.data.logo->setOrigin(0.5, 0);
-			else if (mCarousel.logoAlignment == ALIGN_BOTTOM)
-				e.data.logo->setOrigin(0.5, 1);
-			else
-				e.data.logo->setOrigin(0.5, 0.5);
+			text->setHorizontalAlignment(ALIGN_CENTER);
+			text->setVerticalAlignment(mCarousel.logoAlignment);
 		}
+	}
+
+	if (mCarousel.type == VERTICAL || mCarousel.type == VERTICAL_WHEEL)
+	{
+		if (mCarousel.logoAlignment == ALIGN_LEFT)
+			e.data.logo->setOrigin(0, 0.5);
+		else if (mCarousel.logoAlignment == ALIGN_RIGHT)
+			e.data.logo->setOrigin(1.0, 0.5);
+		else
+			e.data.logo->setOrigin(0.5, 0.5);
+	} else {
+		if (mCarousel.logoAlignment == ALIGN_TOP)
+			e.data.logo->setOrigin(0.5, 0);
+		else if (mCarousel.logoAlignment == ALIGN_BOTTOM)
+			e.data.logo->setOrigin(0.5, 1);
+		else
+			e.data.logo->setOrigin(0.5, 0.5);
+	}
 
-		Eigen::Vector2f denormalized = mCarousel.logoSize.cwiseProduct(e.data.logo->getOrigin());
-		e.data.logo->setPosition(denormalized.x(), denormalized.y(), 0.0);
+	Eigen::Vector2f denormalized = mCarousel.logoSize.cwiseProduct(e.data.logo->getOrigin());
+	e.data.logo->setPosition(denormalized.x(), denormalized.y(), 0.0);
 
-		// delete any existing extras
-		for (auto extra : e.data.backgroundExtras)
-			delete extra;
-		e.data.backgroundExtras.clear();
+	// delete any existing extras
+	for (auto extra : e.data.backgroundExtras)
+		delete extra;
+	e.data.backgroundExtras.clear();
 
-		// make background extras
-		e.data.backgroundExtras = ThemeData::makeExtras((*it)->getTheme(), "system", mWindow);
+	// make background extras
+	e.data.backgroundExtras = ThemeData::makeExtras(system->getTheme(), "system", mWindow);
 
-		// sort the extras by z-index
-		std::stable_sort(e.data.backgroundExtras.begin(), e.data.backgroundExtras.end(),  [](GuiComponent* a, GuiComponent* b) {
-			return b->getZIndex() > a->getZIndex();
-		});
+	// sort the extras by z-index
+	std::stable_sort(e.data.backgroundExtras.begin(), e.data.backgroundExtras.end(),  [](GuiComponent* a, GuiComponent* b) {
+		return b->getZIndex() > a->getZIndex();
+	});
 
-		this->add(e);
-	}
+	this->add(e);
 }
 
 void SystemView::goToSystem(SystemData* system, bool animate)
@@ -346,6 +352,9 @@ void SystemView::render(const Eigen::Affine3f& parentTrans)
 	}
 
 	renderExtras(trans, minMax.second, INT16_MAX);
+
+	if(SystemData::isLoading())
+		renderLoadingProgress(trans);
 }
 
 std::vector<HelpPrompt> SystemView::getHelpPrompts()
@@ -509,6 +518,29 @@ void SystemView::renderInfoBar(const Eigen::Affine3f& trans)
 	mSystemInfo.render(trans);
 }
 
+// Draw how many systems are still loading in the background
+void SystemView::renderLoadingProgress(const Eigen::Affine3f& trans)
+{
+	unsigned int loaded, total;
+	SystemData::getLoadProgress(&loaded, &total);
+
+	if(loaded != mLoadingTextCount || mLoadingText.getValue().empty())
+	{
+		std::stringstream ss;
+		ss << "LOADING SYSTEMS " << loaded << "/" << total;
+		mLoadingText.setText(ss.str());
+		mLoadingTextCount = loaded;
+	}
+
+	mLoadingText.render(trans);
+
+	const float barWidth = mSize.x() * 0.2f;
+	const float barY = mLoadingText.getPosition().y() + mLoadingText.getSize().y();
+	Renderer::setMatrix(trans);
+	Renderer::drawRect((mSize.x() - barWidth) / 2, barY, barWidth, 2.0f, 0x77777740);
+	Renderer::drawRect((mSize.x() - barWidth) / 2, barY, total ? barWidth * loaded / total : 0.0f, 2.0f, 0x777777FF);
+}
+
 // Draw background extras
 void SystemView::renderExtras(const Eigen::Affine3f& trans, float lower, float upper)
 {
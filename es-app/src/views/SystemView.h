@@ -51,6 +51,7 @@ public:
 	virtual void onHide() override;
 
 	void goToSystem(SystemData* system, bool animate);
+	void addSystem(SystemData* system); // appends a system that finished loading after this view was created
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
@@ -74,10 +75,13 @@ private:
 	void renderExtras(const Eigen::Affine3f& parentTrans, float lower, float upper);
 	void renderInfoBar(const Eigen::Affine3f& trans);
 	void renderFade(const Eigen::Affine3f& trans);
+	void renderLoadingProgress(const Eigen::Affine3f& trans);
 
 
 	SystemViewCarousel mCarousel;
 	TextComponent mSystemInfo;
+	TextComponent mLoadingText;
+	unsigned int mLoadingTextCount; // number of loaded systems mLoadingText was last updated for
 
 	// unit is list index
 	float mCamOffset;
@@ -10,10 +10,14 @@
 #include "animations/LaunchAnimation.h"
 #include "animations/MoveCameraAnimation.h"
 #include "animations/LambdaAnimation.h"
+#include <algorithm>
 // #include <SDL.h>
 
 ViewController* ViewController::sInstance = NULL;
 
+// how long there must be no input before views are built in the background, so building one doesn't stall scrolling
+const static int IDLE_PRELOAD_DELAY = 500;
+
 ViewController* ViewController::get()
 {
 	assert(sInstance);
@@ -27,7 +31,7 @@ void ViewController::init(Window* window)
 }
 
 ViewController::ViewController(Window* window)
-	: GuiComponent(window), mCurrentView(nullptr), mCamera(Eigen::Affine3f::Identity()), mFadeOpacity(0), mLockInput(false)
+	: GuiComponent(window), mCurrentView(nullptr), mCamera(Eigen::Affine3f::Identity()), mFadeOpacity(0), mLockInput(false), mIdleTime(0), mPreloadFrame(0)
 {
 	mState.viewing = NOTHING;
 }
@@ -41,7 +45,7 @@ ViewController::~ViewController()
 void ViewController::goToStart()
 {
 	// If we have only 1 system, start directly in the game list
-	if(SystemData::sSystemVector.size() == 1)
+	if(SystemData::sSystemVector.size() == 1 && !SystemData::isLoading())
 	{
 		goToGameList(SystemData::sSystemVector.at(0));
 	} else {
@@ -165,6 +169,10 @@ void ViewController::onFileChanged(FileData* file, FileChangeType change)
 	auto it = mGameListViews.find(file->getSystem());
 	if(it != mGameListViews.cend())
 		it->second->onFileChanged(file, change);
+
+	auto cursor = mEvictedCursors.find(file->getSystem());
+	if(change == FILE_REMOVED && cursor != mEvictedCursors.cend() && cursor->second == file)
+		mEvictedCursors.erase(cursor);
 }
 
 void ViewController::launch(FileData* game, Eigen::Vector3f center)
@@ -220,24 +228,16 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 	//if we already made one, return that one
 	auto exists = mGameListViews.find(system);
 	if(exists != mGameListViews.cend())
+	{
+		touchGameListView(system);
 		return exists->second;
+	}
 
 	//if we didn't, make it, remember it, and return it
 	std::shared_ptr<IGameListView> view;
 
 	//decide type
-	bool detailed = false;
-	std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME | FOLDER);
-	for(auto it = files.cbegin(); it != files.cend(); it++)
-	{
-		if(!(*it)->getThumbnailPath().empty())
-		{
-			detailed = true;
-			break;
-		}
-	}
-
-	if(detailed)
+	if(system->hasArtwork())
 		view = std::shared_ptr<IGameListView>(new DetailedGameListView(mWindow, system->getRootFolder()));
 	else
 		view = std::shared_ptr<IGameListView>(new BasicGameListView(mWindow, system->getRootFolder()));
@@ -248,12 +248,86 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 	int id = std::find(sysVec.cbegin(), sysVec.cend(), system) - sysVec.cbegin();
 	view->setPosition(id * (float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight() * 2);
 
+	// put the cursor back where it was when this view was torn down
+	auto cursor = mEvictedCursors.find(system);
+	if(cursor != mEvictedCursors.cend())
+	{
+		view->setCursor(cursor->second);
+		mEvictedCursors.erase(cursor);
+	}
+
 	addChild(view.get());
 
 	mGameListViews[system] = view;
+	touchGameListView(system);
+	evictGameListViews();
 	return view;
 }
 
+SystemData* ViewController::getFocusedSystem() const
+{
+	if(mState.viewing == SYSTEM_SELECT && mSystemListView && mSystemListView->size())
+		return mSystemListView->getSelected();
+
+	if(mState.viewing == GAME_LIST || mState.viewing == SYSTEM_SELECT)
+		return mState.system;
+
+	return NULL;
+}
+
+bool ViewController::isNearFocusedSystem(SystemData* system) const
+{
+	SystemData* focused = getFocusedSystem();
+	return focused && (system == focused || system == focused->getNext() || system == focused->getPrev());
+}
+
+void ViewController::touchGameListView(SystemData* system)
+{
+	mGameListViewOrder.remove(system);
+	mGameListViewOrder.push_front(system);
+}
+
+void ViewController::evictGameListViews()
+{
+	const int maxViews = Settings::getInstance()->getInt("MaxGameListViews");
+	if(maxViews <= 0)
+		return;
+
+	// the views around the focused system are kept even if that goes over the limit
+	auto it = mGameListViewOrder.end();
+	while((int)mGameListViews.size() > maxViews && it != mGameListViewOrder.begin())
+	{
+		it--;
+		if(isNearFocusedSystem(*it))
+			continue;
+
+		auto view = mGameListViews.find(*it);
+		mEvictedCursors[*it] = view->second->getCursor();
+		mGameListViews.erase(view); // the view removes itself from our children when destroyed
+		it = mGameListViewOrder.erase(it);
+	}
+}
+
+void ViewController::preloadGameListView()
+{
+	// build at most one view per frame, update() runs for every update step of it
+	SystemData* focused = getFocusedSystem();
+	if(!focused || mPreloadFrame == mWindow->getFrameCount())
+		return;
+
+	// starting with the one most likely to be opened next
+	SystemData* candidates[3] = { focused, focused->getNext(), focused->getPrev() };
+	for(int i = 0; i < 3; i++)
+	{
+		if(mGameListViews.find(candidates[i]) == mGameListViews.cend())
+		{
+			getGameListView(candidates[i]);
+			mPreloadFrame = mWindow->getFrameCount();
+			return;
+		}
+	}
+}
+
 std::shared_ptr<SystemView> ViewController::getSystemListView()
 {
 	//if we already made one, return that one
@@ -269,6 +343,8 @@ std::shared_ptr<SystemView> ViewController::getSystemListView()
 
 bool ViewController::input(InputConfig* config, Input input)
 {
+	mIdleTime = 0;
+
 	if(mLockInput)
 		return true;
 
@@ -288,12 +364,24 @@ bool ViewController::input(InputConfig* config, Input input)
 
 void ViewController::update(int deltaTime)
 {
+	if(SystemData::isLoading())
+	{
+		addLoadedSystems();
+		invalidate(); // progress text
+	}
+
 	if(mCurrentView)
 	{
 		mCurrentView->update(deltaTime);
 	}
 
 	updateSelf(deltaTime);
+
+	mIdleTime = std::min(mIdleTime + deltaTime, IDLE_PRELOAD_DELAY); // no further, it only has to get there
+	if(mIdleTime < IDLE_PRELOAD_DELAY)
+		mWindow->scheduleUpdate(IDLE_PRELOAD_DELAY - mIdleTime);
+	else if(!isAnimationPlaying(0) && mWindow->peekGui() == this)
+		preloadGameListView();
 }
 
 void ViewController::render(const Eigen::Affine3f& parentTrans)
@@ -330,12 +418,18 @@ void ViewController::render(const Eigen::Affine3f& parentTrans)
 	}
 }
 
-void ViewController::preload()
+void ViewController::addLoadedSystems()
 {
-	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
+	std::vector<SystemData*> systems = SystemData::collectLoadedSystems();
+	for(auto it = systems.cbegin(); it != systems.cend(); it++)
 	{
-		getGameListView(*it);
+		// systems are only ever appended, so the views that are already placed keep their positions
+		if(mSystemListView)
+			mSystemListView->addSystem(*it);
 	}
+
+	if(systems.size())
+		updateHelpPrompts();
 }
 
 void ViewController::reloadGameListView(IGameListView* view, bool reloadTheme)
@@ -371,12 +465,14 @@ void ViewController::reloadAll()
 		cursorMap[it->first] = it->second->getCursor();
 	}
 	mGameListViews.clear();
+	mGameListViewOrder.clear();
+
+	// views that aren't built yet pick up their new theme when they are
+	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
+		(*it)->loadTheme();
 
 	for(auto it = cursorMap.cbegin(); it != cursorMap.cend(); it++)
-	{
-		it->first->loadTheme();
 		getGameListView(it->first)->setCursor(it->second);
-	}
 
 	mSystemListView.reset();
 	getSystemListView();
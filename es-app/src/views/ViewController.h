@@ -4,6 +4,7 @@
 
 #include "views/gamelist/IGameListView.h"
 #include "views/SystemView.h"
+#include <list>
 
 class SystemData;
 
@@ -16,9 +17,9 @@ public:
 
 	virtual ~ViewController();
 
-	// Try to completely populate the GameListView map.
-	// Caches things so there's no pauses during transitions.
-	void preload();
+	// Adds systems that finished loading in the background (see SystemData::loadConfigAsync()) to the system view.
+	// Called every update while systems are loading.
+	void addLoadedSystems();
 
 	// If a basic view detected a metadata change, it can request to recreate
 	// the current gamelist view (as it may change to be detailed).
@@ -67,6 +68,8 @@ public:
 	virtual std::vector<HelpPrompt> getHelpPrompts() override;
 	virtual HelpStyle getHelpStyle() override;
 
+	// Gamelist views are built on first use, or while idle for the systems one button press away.
+	// At most "MaxGameListViews" are kept, the least recently used ones are torn down first.
 	std::shared_ptr<IGameListView> getGameListView(SystemData* system);
 	std::shared_ptr<SystemView> getSystemListView();
 
@@ -76,9 +79,19 @@ private:
 
 	void playViewTransition();
 	int getSystemId(SystemData* system);
+
+	SystemData* getFocusedSystem() const; // the system being looked at, either in the carousel or as a gamelist
+	bool isNearFocusedSystem(SystemData* system) const;
+	void touchGameListView(SystemData* system);
+	void evictGameListViews();
+	void preloadGameListView();
 	
 	std::shared_ptr<GuiComponent> mCurrentView;
 	std::map< SystemData*, std::shared_ptr<IGameListView> > mGameListViews;
+	std::list<SystemData*> mGameListViewOrder; // systems in mGameListViews, most recently used first
+	std::map<SystemData*, FileData*> mEvictedCursors; // cursors of torn down views, restored when they're rebuilt
+	int mIdleTime; // ms since the last input, up to IDLE_PRELOAD_DELAY
+	unsigned int mPreloadFrame; // Window::getFrameCount() when a view was last preloaded
 	std::shared_ptr<SystemView> mSystemListView;
 	
 	Eigen::Affine3f mCamera;
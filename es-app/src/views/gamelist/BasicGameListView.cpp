@@ -28,9 +28,10 @@ void BasicGameListView::onThemeChanged(const std::shared_ptr<ThemeData>& theme)
 
 void BasicGameListView::onFileChanged(FileData* file, FileChangeType change)
 {
-	if(change == FILE_METADATA_CHANGED)
+	if(change == FILE_METADATA_CHANGED && file->hasArtwork())
 	{
-		// might switch to a detailed view
+		// switch to a detailed view
+		file->getSystem()->setHasArtwork();
 		ViewController::get()->reloadGameListView(this);
 		return;
 	}
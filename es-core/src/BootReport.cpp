@@ -0,0 +1,159 @@
+#include "BootReport.h"
+#include <chrono>
+#include <map>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include "Settings.h"
+#include "Log.h"
+#include "platform.h"
+
+std::atomic<bool> BootReport::sFinished(false);
+long long BootReport::sTotalTime = 0;
+std::vector<BootReport::Entry> BootReport::sEntries;
+std::mutex BootReport::sMutex;
+
+static thread_local int sDepth = 0;
+
+long long BootReport::now()
+{
+	static const auto epoch = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+int BootReport::getThreadIndex()
+{
+	static std::atomic<int> threadCount(0);
+	static thread_local int index = threadCount++;
+	return index;
+}
+
+BootReport::Phase::Phase(const char* name, const std::string& system) : mIndex(-1)
+{
+	if(sFinished)
+		return;
+
+	Entry entry = { name, system, now(), 0, sDepth, getThreadIndex() };
+
+	std::unique_lock<std::mutex> lock(sMutex);
+	mIndex = (int)sEntries.size();
+	sEntries.push_back(entry);
+	sDepth++;
+}
+
+BootReport::Phase::~Phase()
+{
+	if(mIndex < 0)
+		return;
+
+	sDepth--;
+
+	// finish() may have been called while this phase was open
+	std::unique_lock<std::mutex> lock(sMutex);
+	if(sFinished)
+		return;
+
+	Entry& entry = sEntries.at(mIndex);
+	entry.duration = now() - entry.start;
+}
+
+std::vector<std::pair<std::string, long long> > BootReport::getSystemTotals()
+{
+	// per-system phases don't nest inside each other, so they can simply be added up
+	std::map<std::string, long long> totals;
+	for(auto it = sEntries.cbegin(); it != sEntries.cend(); it++)
+	{
+		if(!it->system.empty())
+			totals[it->system] += it->duration;
+	}
+
+	std::vector<std::pair<std::string, long long> > sorted(totals.cbegin(), totals.cend());
+	std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, long long>& a, const std::pair<std::string, long long>& b) { return a.second > b.second; });
+	return sorted;
+}
+
+void BootReport::finish()
+{
+	std::unique_lock<std::mutex> lock(sMutex);
+	if(sFinished)
+		return;
+
+	sTotalTime = now();
+	sFinished = true;
+
+	LOG(LogInfo) << "Boot took " << sTotalTime / 1000 << "ms:";
+	for(auto it = sEntries.cbegin(); it != sEntries.cend(); it++)
+	{
+		std::stringstream ss;
+		ss << std::string(2 + it->depth * 2, ' ') << it->name;
+		if(it->thread != 0)
+			ss << " (thread " << it->thread << ")";
+		if(!it->system.empty())
+			ss << " [" << it->system << "]";
+
+		LOG(LogInfo) << std::left << std::setw(48) << ss.str() << std::right << std::setw(6) << it->duration / 1000 << "ms";
+	}
+
+	const auto systems = getSystemTotals();
+	if(systems.size())
+	{
+		LOG(LogInfo) << "Slowest systems to load:";
+		for(unsigned int i = 0; i < systems.size() && i < 5; i++)
+			LOG(LogInfo) << "  " << std::left << std::setw(46) << systems.at(i).first << std::right << std::setw(6) << systems.at(i).second / 1000 << "ms";
+	}
+
+	if(Settings::getInstance()->getBool("BootReport"))
+		writeReport(getReportPath());
+}
+
+std::string BootReport::getReportPath()
+{
+	return getHomePath() + "/.emulationstation/es_boot.json";
+}
+
+static std::string escapeJSON(const std::string& str)
+{
+	std::string out;
+	for(auto c = str.cbegin(); c != str.cend(); c++)
+	{
+		if(*c == '"' || *c == '\\')
+			out += '\\';
+
+		out += *c;
+	}
+	return out;
+}
+
+bool BootReport::writeReport(const std::string& path)
+{
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc);
+	if(!file.is_open())
+	{
+		LOG(LogError) << "Could not write boot report to " << path;
+		return false;
+	}
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\"total_ms\":" << sTotalTime / 1000.0 << ",\n\"phases\":[";
+
+	for(auto it = sEntries.cbegin(); it != sEntries.cend(); it++)
+	{
+		file << (it == sEntries.cbegin() ? "\n" : ",\n") << "{\"name\":\"" << escapeJSON(it->name) << "\"";
+		if(!it->system.empty())
+			file << ",\"system\":\"" << escapeJSON(it->system) << "\"";
+		file << ",\"thread\":" << it->thread << ",\"depth\":" << it->depth << ",\"start_ms\":" << it->start / 1000.0 << ",\"duration_ms\":" << it->duration / 1000.0 << "}";
+	}
+
+	file << "\n],\n\"systems\":[";
+
+	const auto systems = getSystemTotals();
+	for(auto it = systems.cbegin(); it != systems.cend(); it++)
+		file << (it == systems.cbegin() ? "\n" : ",\n") << "{\"name\":\"" << escapeJSON(it->first) << "\",\"duration_ms\":" << it->second / 1000.0 << "}";
+
+	file << "\n]}\n";
+	file.close();
+
+	LOG(LogInfo) << "Wrote boot report to " << path;
+	return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#ifndef ES_CORE_BOOT_REPORT_H
+#define ES_CORE_BOOT_REPORT_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+
+//Times the phases of startup (settings, window, system scan, gamelists, themes, start view, first frame).
+//Phases are recorded from the first Phase until finish() is called, after which a Phase does nothing,
+//so code that also runs after boot (like SystemData::loadTheme()) can keep its Phase unconditionally.
+//Phases may be recorded from any thread, nesting is tracked per thread.
+class BootReport
+{
+public:
+	struct Entry
+	{
+		std::string name;
+		std::string system; // empty if the phase is not tied to a system
+		long long start; // microseconds since the first phase started
+		long long duration; // microseconds, including nested phases
+		int depth;
+		int thread; // 0 for the thread that recorded the first phase, then numbered in order of appearance
+	};
+
+	//Records a phase that lasts for the lifetime of this object. Phases may be nested.
+	class Phase
+	{
+	public:
+		Phase(const char* name, const std::string& system = "");
+		~Phase();
+
+	private:
+		int mIndex;
+	};
+
+	static inline bool isFinished() { return sFinished; }
+
+	//Stops recording, logs the report and writes it as JSON if the "BootReport" setting is set.
+	static void finish();
+
+	static std::string getReportPath();
+	static bool writeReport(const std::string& path);
+
+	static inline long long getTotalTime() { return sTotalTime; }
+
+private:
+	static long long now();
+	static int getThreadIndex();
+	static std::vector<std::pair<std::string, long long> > getSystemTotals(); // sorted by time, highest first
+
+	static std::atomic<bool> sFinished;
+	static long long sTotalTime;
+	static std::vector<Entry> sEntries;
+	static std::mutex sMutex; // guards sEntries
+};
+
+#endif // ES_CORE_BOOT_REPORT_H
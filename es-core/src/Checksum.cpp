@@ -0,0 +1,272 @@
+#include "Checksum.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	struct Crc32Table
+	{
+		unsigned int entries[256];
+
+		Crc32Table()
+		{
+			// reflected, polynomial 0x04C11DB7 - the one zip, ScreenScraper and No-Intro use
+			for(unsigned int i = 0; i < 256; i++)
+			{
+				unsigned int crc = i;
+				for(int bit = 0; bit < 8; bit++)
+					crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+				entries[i] = crc;
+			}
+		}
+	};
+
+	const Crc32Table sCrc32Table;
+
+	inline unsigned int rotateLeft(unsigned int value, int bits)
+	{
+		return (value << bits) | (value >> (32 - bits));
+	}
+
+	std::string toHex(const unsigned char* bytes, size_t length)
+	{
+		std::string hex(length * 2, '0');
+		for(size_t i = 0; i < length; i++)
+		{
+			hex[i * 2] = "0123456789abcdef"[bytes[i] >> 4];
+			hex[i * 2 + 1] = "0123456789abcdef"[bytes[i] & 0xF];
+		}
+
+		return hex;
+	}
+
+	// MD5 and SHA-1 both work on 64 byte blocks and end with the message length, they only disagree on its byte order
+	template<typename Transform>
+	void addBlocks(const void* data, size_t length, unsigned long long& total, unsigned char* buffer, Transform transform)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		size_t used = (size_t)(total % 64);
+		total += length;
+
+		if(used > 0)
+		{
+			const size_t count = std::min(length, 64 - used);
+			memcpy(buffer + used, bytes, count);
+			bytes += count;
+			length -= count;
+			used += count;
+
+			if(used < 64)
+				return;
+
+			transform(buffer);
+		}
+
+		for(; length >= 64; bytes += 64, length -= 64)
+			transform(bytes);
+
+		memcpy(buffer, bytes, length);
+	}
+
+	template<typename Transform>
+	void addPadding(unsigned long long total, unsigned char* buffer, bool bigEndian, Transform transform)
+	{
+		size_t used = (size_t)(total % 64);
+		buffer[used++] = 0x80;
+
+		if(used > 56)
+		{
+			memset(buffer + used, 0, 64 - used);
+			transform(buffer);
+			used = 0;
+		}
+
+		memset(buffer + used, 0, 56 - used);
+
+		const unsigned long long bits = total * 8;
+		for(int i = 0; i < 8; i++)
+			buffer[bigEndian ? 63 - i : 56 + i] = (unsigned char)(bits >> (i * 8));
+
+		transform(buffer);
+	}
+}
+
+// Crc32
+Crc32::Crc32() : mCrc(0xFFFFFFFF)
+{
+}
+
+void Crc32::update(const void* data, size_t length)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	unsigned int crc = mCrc;
+	for(size_t i = 0; i < length; i++)
+		crc = sCrc32Table.entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+	mCrc = crc;
+}
+
+std::string Crc32::finish()
+{
+	return toHex(mCrc ^ 0xFFFFFFFF);
+}
+
+std::string Crc32::toHex(unsigned int crc)
+{
+	char hex[9];
+	snprintf(hex, sizeof(hex), "%08x", crc);
+	return hex;
+}
+
+// Md5
+Md5::Md5() : mLength(0)
+{
+	mState[0] = 0x67452301;
+	mState[1] = 0xEFCDAB89;
+	mState[2] = 0x98BADCFE;
+	mState[3] = 0x10325476;
+}
+
+void Md5::transform(const unsigned char* block)
+{
+	static const unsigned int K[64] = {
+		0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+		0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+		0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+		0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+		0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+		0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+		0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+		0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+	};
+	static const int R[64] = {
+		7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+		5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+		4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+		6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+	};
+
+	unsigned int m[16];
+	for(int i = 0; i < 16; i++)
+		m[i] = block[i * 4] | (block[i * 4 + 1] << 8) | (block[i * 4 + 2] << 16) | ((unsigned int)block[i * 4 + 3] << 24);
+
+	unsigned int a = mState[0], b = mState[1], c = mState[2], d = mState[3];
+	for(int i = 0; i < 64; i++)
+	{
+		unsigned int f;
+		int g;
+		if(i < 16)
+		{
+			f = (b & c) | (~b & d);
+			g = i;
+		}else if(i < 32)
+		{
+			f = (d & b) | (~d & c);
+			g = (5 * i + 1) % 16;
+		}else if(i < 48)
+		{
+			f = b ^ c ^ d;
+			g = (3 * i + 5) % 16;
+		}else{
+			f = c ^ (b | ~d);
+			g = (7 * i) % 16;
+		}
+
+		const unsigned int temp = d;
+		d = c;
+		c = b;
+		b = b + rotateLeft(a + f + K[i] + m[g], R[i]);
+		a = temp;
+	}
+
+	mState[0] += a;
+	mState[1] += b;
+	mState[2] += c;
+	mState[3] += d;
+}
+
+void Md5::update(const void* data, size_t length)
+{
+	addBlocks(data, length, mLength, mBuffer, [this](const unsigned char* block) { transform(block); });
+}
+
+std::string Md5::finish()
+{
+	addPadding(mLength, mBuffer, false, [this](const unsigned char* block) { transform(block); });
+
+	unsigned char digest[16];
+	for(int i = 0; i < 16; i++)
+		digest[i] = (unsigned char)(mState[i / 4] >> ((i % 4) * 8));
+
+	return toHex(digest, sizeof(digest));
+}
+
+// Sha1
+Sha1::Sha1() : mLength(0)
+{
+	mState[0] = 0x67452301;
+	mState[1] = 0xEFCDAB89;
+	mState[2] = 0x98BADCFE;
+	mState[3] = 0x10325476;
+	mState[4] = 0xC3D2E1F0;
+}
+
+void Sha1::transform(const unsigned char* block)
+{
+	unsigned int w[80];
+	for(int i = 0; i < 16; i++)
+		w[i] = ((unsigned int)block[i * 4] << 24) | (block[i * 4 + 1] << 16) | (block[i * 4 + 2] << 8) | block[i * 4 + 3];
+	for(int i = 16; i < 80; i++)
+		w[i] = rotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+	unsigned int a = mState[0], b = mState[1], c = mState[2], d = mState[3], e = mState[4];
+	for(int i = 0; i < 80; i++)
+	{
+		unsigned int f, k;
+		if(i < 20)
+		{
+			f = (b & c) | (~b & d);
+			k = 0x5A827999;
+		}else if(i < 40)
+		{
+			f = b ^ c ^ d;
+			k = 0x6ED9EBA1;
+		}else if(i < 60)
+		{
+			f = (b & c) | (b & d) | (c & d);
+			k = 0x8F1BBCDC;
+		}else{
+			f = b ^ c ^ d;
+			k = 0xCA62C1D6;
+		}
+
+		const unsigned int temp = rotateLeft(a, 5) + f + e + k + w[i];
+		e = d;
+		d = c;
+		c = rotateLeft(b, 30);
+		b = a;
+		a = temp;
+	}
+
+	mState[0] += a;
+	mState[1] += b;
+	mState[2] += c;
+	mState[3] += d;
+	mState[4] += e;
+}
+
+void Sha1::update(const void* data, size_t length)
+{
+	addBlocks(data, length, mLength, mBuffer, [this](const unsigned char* block) { transform(block); });
+}
+
+std::string Sha1::finish()
+{
+	addPadding(mLength, mBuffer, true, [this](const unsigned char* block) { transform(block); });
+
+	unsigned char digest[20];
+	for(int i = 0; i < 20; i++)
+		digest[i] = (unsigned char)(mState[i / 4] >> ((3 - i % 4) * 8));
+
+	return toHex(digest, sizeof(digest));
+}
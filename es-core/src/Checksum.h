@@ -0,0 +1,56 @@
+#pragma once
+#ifndef ES_CORE_CHECKSUM_H
+#define ES_CORE_CHECKSUM_H
+
+#include <string>
+
+// Incremental checksums for hashing files a block at a time. Feed the data with update(), then call finish() once,
+// which returns the digest as lowercase hex. Nothing is shared between instances, so they are safe to use from any thread.
+
+class Crc32
+{
+public:
+	Crc32();
+
+	void update(const void* data, size_t length);
+	std::string finish();
+
+	static std::string toHex(unsigned int crc); // as finish() formats it
+
+private:
+	unsigned int mCrc;
+};
+
+class Md5
+{
+public:
+	Md5();
+
+	void update(const void* data, size_t length);
+	std::string finish();
+
+private:
+	void transform(const unsigned char* block);
+
+	unsigned int mState[4];
+	unsigned long long mLength; // bytes
+	unsigned char mBuffer[64];
+};
+
+class Sha1
+{
+public:
+	Sha1();
+
+	void update(const void* data, size_t length);
+	std::string finish();
+
+private:
+	void transform(const unsigned char* block);
+
+	unsigned int mState[5];
+	unsigned long long mLength; // bytes
+	unsigned char mBuffer[64];
+};
+
+#endif // ES_CORE_CHECKSUM_H
@@ -4,6 +4,7 @@
 #include "Renderer.h"
 #include "animations/AnimationController.h"
 #include "ThemeData.h"
+#include "Profiler.h"
 
 GuiComponent::GuiComponent(Window* window) : mWindow(window), mParent(NULL), mOpacity(255),
 	mPosition(Eigen::Vector3f::Zero()), mOrigin(Eigen::Vector2f::Zero()), mRotationOrigin(0.5, 0.5),
@@ -47,6 +48,7 @@ void GuiComponent::updateChildren(int deltaTime)
 {
 	for(unsigned int i = 0; i < getChildCount(); i++)
 	{
+		Profiler::Scope scope(getChild(i), "update");
 		getChild(i)->update(deltaTime);
 	}
 }
@@ -67,6 +69,7 @@ void GuiComponent::renderChildren(const Eigen::Affine3f& transform) const
 {
 	for(unsigned int i = 0; i < getChildCount(); i++)
 	{
+		Profiler::Scope scope(getChild(i), "render");
 		getChild(i)->render(transform);
 	}
 }
@@ -78,8 +81,13 @@ Eigen::Vector3f GuiComponent::getPosition() const
 
 void GuiComponent::setPosition(float x, float y, float z)
 {
+	// views set their children's transforms while rendering, so only a real change may dirty the window
+	if(mPosition == Eigen::Vector3f(x, y, z))
+		return;
+
 	mPosition << x, y, z;
 	onPositionChanged();
+	invalidate();
 }
 
 Eigen::Vector2f GuiComponent::getOrigin() const
@@ -89,8 +97,12 @@ Eigen::Vector2f GuiComponent::getOrigin() const
 
 void GuiComponent::setOrigin(float x, float y)
 {
+	if(mOrigin == Eigen::Vector2f(x, y))
+		return;
+
 	mOrigin << x, y;
 	onOriginChanged();
+	invalidate();
 }
 
 Eigen::Vector2f GuiComponent::getRotationOrigin() const
@@ -100,7 +112,11 @@ Eigen::Vector2f GuiComponent::getRotationOrigin() const
 
 void GuiComponent::setRotationOrigin(float x, float y)
 {
-	mRotationOrigin << x, y;;
+	if(mRotationOrigin == Eigen::Vector2f(x, y))
+		return;
+
+	mRotationOrigin << x, y;
+	invalidate();
 }
 
 Eigen::Vector2f GuiComponent::getSize() const
@@ -110,6 +126,10 @@ Eigen::Vector2f GuiComponent::getSize() const
 
 void GuiComponent::setSize(float w, float h)
 {
+	// setSize() with the current size is used to redo a layout, so onSizeChanged() still runs
+	if(mSize != Eigen::Vector2f(w, h))
+		invalidate();
+
 	mSize << w, h;
     onSizeChanged();
 }
@@ -121,7 +141,11 @@ float GuiComponent::getRotation() const
 
 void GuiComponent::setRotation(float rotation)
 {
+	if(mRotation == rotation)
+		return;
+
 	mRotation = rotation;
+	invalidate();
 }
 
 float GuiComponent::getScale() const
@@ -131,7 +155,11 @@ float GuiComponent::getScale() const
 
 void GuiComponent::setScale(float scale)
 {
+	if(mScale == scale)
+		return;
+
 	mScale = scale;
+	invalidate();
 }
 
 float GuiComponent::getZIndex() const
@@ -141,7 +169,11 @@ float GuiComponent::getZIndex() const
 
 void GuiComponent::setZIndex(float z)
 {
+	if(mZIndex == z)
+		return;
+
 	mZIndex = z;
+	invalidate();
 }
 
 float GuiComponent::getDefaultZIndex() const
@@ -169,6 +201,7 @@ void GuiComponent::addChild(GuiComponent* cmp)
 		cmp->getParent()->removeChild(cmp);
 
 	cmp->setParent(this);
+	invalidate();
 }
 
 void GuiComponent::removeChild(GuiComponent* cmp)
@@ -182,6 +215,7 @@ void GuiComponent::removeChild(GuiComponent* cmp)
 	}
 
 	cmp->setParent(NULL);
+	invalidate();
 
 	for(auto i = mChildren.cbegin(); i != mChildren.cend(); i++)
 	{
@@ -196,6 +230,7 @@ void GuiComponent::removeChild(GuiComponent* cmp)
 void GuiComponent::clearChildren()
 {
 	mChildren.clear();
+	invalidate();
 }
 
 void GuiComponent::sortChildren()
@@ -232,6 +267,9 @@ unsigned char GuiComponent::getOpacity() const
 
 void GuiComponent::setOpacity(unsigned char opacity)
 {
+	if(mOpacity != opacity)
+		invalidate();
+
 	mOpacity = opacity;
 	for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
 	{
@@ -347,6 +385,7 @@ bool GuiComponent::advanceAnimation(unsigned char slot, unsigned int time)
 	AnimationController* anim = mAnimationMap[slot];
 	if(anim)
 	{
+		invalidate();
 		bool done = anim->update(time);
 		if(done)
 		{
@@ -390,6 +429,14 @@ int GuiComponent::getAnimationTime(unsigned char slot) const
 
 void GuiComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties)
 {
+	// looked up once, this runs for every element of every view
+	static const ThemeData::PropertyInfo* posProp = ThemeData::getPropertyInfo("pos");
+	static const ThemeData::PropertyInfo* sizeProp = ThemeData::getPropertyInfo("size");
+	static const ThemeData::PropertyInfo* originProp = ThemeData::getPropertyInfo("origin");
+	static const ThemeData::PropertyInfo* rotationProp = ThemeData::getPropertyInfo("rotation");
+	static const ThemeData::PropertyInfo* rotationOriginProp = ThemeData::getPropertyInfo("rotationOrigin");
+	static const ThemeData::PropertyInfo* zIndexProp = ThemeData::getPropertyInfo("zIndex");
+
 	Eigen::Vector2f scale = getParent() ? getParent()->getSize() : Eigen::Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 
 	const ThemeData::ThemeElement* elem = theme->getElement(view, element, "");
@@ -397,28 +444,28 @@ void GuiComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const std
 		return;
 
 	using namespace ThemeFlags;
-	if(properties & POSITION && elem->has("pos"))
+	if(properties & POSITION && elem->has(posProp))
 	{
-		Eigen::Vector2f denormalized = elem->get<Eigen::Vector2f>("pos").cwiseProduct(scale);
+		Eigen::Vector2f denormalized = elem->get<Eigen::Vector2f>(posProp).cwiseProduct(scale);
 		setPosition(Eigen::Vector3f(denormalized.x(), denormalized.y(), 0));
 	}
 
-	if(properties & ThemeFlags::SIZE && elem->has("size"))
-		setSize(elem->get<Eigen::Vector2f>("size").cwiseProduct(scale));
+	if(properties & ThemeFlags::SIZE && elem->has(sizeProp))
+		setSize(elem->get<Eigen::Vector2f>(sizeProp).cwiseProduct(scale));
 
 	// position + size also implies origin
-	if((properties & ORIGIN || (properties & POSITION && properties & ThemeFlags::SIZE)) && elem->has("origin"))
-		setOrigin(elem->get<Eigen::Vector2f>("origin"));
+	if((properties & ORIGIN || (properties & POSITION && properties & ThemeFlags::SIZE)) && elem->has(originProp))
+		setOrigin(elem->get<Eigen::Vector2f>(originProp));
 
 	if(properties & ThemeFlags::ROTATION) {
-		if(elem->has("rotation"))
-			setRotationDegrees(elem->get<float>("rotation"));
-		if(elem->has("rotationOrigin"))
-			setRotationOrigin(elem->get<Eigen::Vector2f>("rotationOrigin"));
+		if(elem->has(rotationProp))
+			setRotationDegrees(elem->get<float>(rotationProp));
+		if(elem->has(rotationOriginProp))
+			setRotationOrigin(elem->get<Eigen::Vector2f>(rotationOriginProp));
 	}
 
-	if(properties & ThemeFlags::Z_INDEX && elem->has("zIndex"))
-		setZIndex(elem->get<float>("zIndex"));
+	if(properties & ThemeFlags::Z_INDEX && elem->has(zIndexProp))
+		setZIndex(elem->get<float>(zIndexProp));
 	else
 		setZIndex(getDefaultZIndex());
 }
@@ -458,3 +505,8 @@ void GuiComponent::onHide()
 	for(unsigned int i = 0; i < getChildCount(); i++)
 		getChild(i)->onHide();
 }
+
+void GuiComponent::invalidate()
+{
+	mWindow->invalidate();
+}
@@ -129,6 +129,11 @@ public:
 	// Returns true if the component is busy doing background processing (e.g. HTTP downloads)
 	bool isProcessing() const;
 
+	// Tells the window that something on screen changed, so the next frame has to be drawn.
+	// The setters here, animations and input already do this; a component that changes by itself over time
+	// (marquees, blinking, held buttons) must call it from update().
+	void invalidate();
+
 protected:
 	void renderChildren(const Eigen::Affine3f& transform) const;
 	void updateSelf(int deltaTime); // updates animations
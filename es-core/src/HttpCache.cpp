@@ -0,0 +1,355 @@
+#include "HttpCache.h"
+#include "Checksum.h"
+#include "Log.h"
+#include "platform.h"
+#include "Settings.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+HttpCache* HttpCache::sInstance = NULL;
+
+namespace
+{
+	std::string toLower(std::string str)
+	{
+		std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+		return str;
+	}
+
+	// what's kept to tell URLs with the same key apart - not the URL itself, which can carry API keys and passwords
+	std::string getCheck(const std::string& url)
+	{
+		Sha1 sha1;
+		sha1.update(url.data(), url.length());
+		return sha1.finish();
+	}
+
+	std::string stripSpaces(const std::string& str)
+	{
+		const size_t start = str.find_first_not_of(" \t\r\n");
+		if(start == std::string::npos)
+			return "";
+
+		return str.substr(start, str.find_last_not_of(" \t\r\n") - start + 1);
+	}
+}
+
+HttpCache* HttpCache::getInstance()
+{
+	if(sInstance == NULL)
+		sInstance = new HttpCache();
+
+	return sInstance;
+}
+
+HttpCache::HttpCache() : mSize(0)
+{
+	mDir = getHomePath() + "/.emulationstation/http_cache";
+	mMaxSize = (unsigned long long)std::max(Settings::getInstance()->getInt("HttpCacheSize"), 0) * 1024 * 1024;
+	mTTL = Settings::getInstance()->getInt("HttpCacheTTL");
+
+	if(!isEnabled())
+		return;
+
+	boost::system::error_code ec;
+	fs::create_directories(mDir, ec);
+	if(ec)
+	{
+		LOG(LogError) << "Could not create HTTP cache directory \"" << mDir << "\", caching is off: " << ec.message();
+		mMaxSize = 0;
+		return;
+	}
+
+	// what's already there, with the body's modification time standing in for when it was last used
+	for(fs::directory_iterator it(mDir, ec), end; !ec && it != end; it.increment(ec))
+	{
+		const fs::path& path = it->path();
+		if(path.extension() == ".tmp")
+		{
+			fs::remove(path, ec); // left over from a crash
+			continue;
+		}
+
+		if(path.extension() != ".body")
+			continue;
+
+		IndexEntry entry;
+		entry.size = fs::file_size(path, ec);
+		entry.lastUsed = fs::last_write_time(path, ec);
+		mIndex[path.stem().string()] = entry;
+		mSize += entry.size;
+	}
+
+	trim();
+}
+
+std::string HttpCache::getKey(const std::string& url)
+{
+	// FNV-1a, so keys stay the same between runs and builds
+	unsigned long long hash = 14695981039346656037ull;
+	for(size_t i = 0; i < url.length(); i++)
+	{
+		hash ^= (unsigned char)url[i];
+		hash *= 1099511628211ull;
+	}
+
+	char key[17];
+	snprintf(key, sizeof(key), "%016llx", hash);
+	return key;
+}
+
+std::string HttpCache::getPath(const std::string& key, const char* extension) const
+{
+	return mDir + "/" + key + extension;
+}
+
+bool HttpCache::readEntry(const std::string& key, const std::string& url, Entry& entry) const
+{
+	std::ifstream file(getPath(key, ".meta"));
+	std::string check;
+	std::string expires;
+	if(!std::getline(file, check) || !std::getline(file, entry.etag) || !std::getline(file, entry.lastModified) || !std::getline(file, expires))
+		return false;
+
+	// a different URL with the same hash
+	if(check != getCheck(url))
+		return false;
+
+	entry.expires = (time_t)atoll(expires.c_str());
+	return true;
+}
+
+bool HttpCache::writeEntry(const std::string& key, const std::string& url, const Entry& entry) const
+{
+	const std::string tmpPath = getPath(key, ".meta.tmp");
+	{
+		std::ofstream file(tmpPath);
+		file << getCheck(url) << "\n" << entry.etag << "\n" << entry.lastModified << "\n" << (long long)entry.expires << "\n";
+		if(file.fail())
+			return false;
+	}
+
+	boost::system::error_code ec;
+	fs::rename(tmpPath, getPath(key, ".meta"), ec);
+	return !ec;
+}
+
+bool HttpCache::find(const std::string& url, Entry& entry)
+{
+	if(!isEnabled())
+		return false;
+
+	const std::string key = getKey(url);
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if(mIndex.find(key) == mIndex.cend())
+			return false;
+	}
+
+	return readEntry(key, url, entry);
+}
+
+bool HttpCache::read(const std::string& url, std::string& body)
+{
+	const std::string key = getKey(url);
+	std::ifstream file(getPath(key, ".body"), std::ios_base::in | std::ios_base::binary);
+	if(!file.is_open())
+		return false;
+
+	std::ostringstream stream;
+	stream << file.rdbuf();
+	if(file.bad())
+		return false;
+
+	body = stream.str();
+
+	touch(key);
+	return true;
+}
+
+bool HttpCache::copyTo(const std::string& url, const std::string& path)
+{
+	const std::string key = getKey(url);
+
+	boost::system::error_code ec;
+	fs::copy_file(getPath(key, ".body"), path, fs::copy_option::overwrite_if_exists, ec);
+	if(ec)
+		return false;
+
+	touch(key);
+	return true;
+}
+
+bool HttpCache::makeEntry(const std::string& headers, Entry& entry) const
+{
+	const time_t now = time(NULL);
+	entry.expires = now + mTTL;
+
+	std::istringstream stream(headers);
+	std::string line;
+	while(std::getline(stream, line))
+	{
+		const size_t colon = line.find(':');
+		if(colon == std::string::npos)
+			continue;
+
+		const std::string name = toLower(stripSpaces(line.substr(0, colon)));
+		const std::string value = stripSpaces(line.substr(colon + 1));
+
+		if(name == "etag")
+		{
+			entry.etag = value;
+		}else if(name == "last-modified")
+		{
+			entry.lastModified = value;
+		}else if(name == "cache-control")
+		{
+			const std::string directives = toLower(value);
+			if(directives.find("no-store") != std::string::npos)
+				return false;
+
+			const size_t maxAge = directives.find("max-age=");
+			if(directives.find("no-cache") != std::string::npos)
+				entry.expires = now; // keep it, but check with the server every time
+			else if(maxAge != std::string::npos)
+				entry.expires = now + atol(directives.c_str() + maxAge + 8);
+		}
+	}
+
+	// stale straight away and no way to check it's still good, not worth keeping
+	return entry.isFresh() || entry.canRevalidate();
+}
+
+void HttpCache::store(const std::string& url, const Entry& entry, const std::string& body)
+{
+	if(!isEnabled() || body.length() > mMaxSize)
+		return;
+
+	const std::string key = getKey(url);
+	const std::string tmpPath = getPath(key, ".body.tmp");
+	{
+		std::ofstream file(tmpPath, std::ios_base::out | std::ios_base::binary);
+		file.write(body.data(), body.length());
+		if(file.fail())
+		{
+			LOG(LogWarning) << "Could not write to the HTTP cache, disk full?";
+			return;
+		}
+	}
+
+	boost::system::error_code ec;
+	fs::rename(tmpPath, getPath(key, ".body"), ec);
+	if(ec || !writeEntry(key, url, entry))
+		return;
+
+	add(key, body.length());
+}
+
+void HttpCache::storeFile(const std::string& url, const Entry& entry, const std::string& path)
+{
+	if(!isEnabled())
+		return;
+
+	boost::system::error_code ec;
+	const unsigned long long size = fs::file_size(path, ec);
+	if(ec || size > mMaxSize)
+		return;
+
+	const std::string key = getKey(url);
+	const std::string tmpPath = getPath(key, ".body.tmp");
+	fs::copy_file(path, tmpPath, fs::copy_option::overwrite_if_exists, ec);
+	if(ec)
+	{
+		LOG(LogWarning) << "Could not write to the HTTP cache: " << ec.message();
+		return;
+	}
+
+	fs::rename(tmpPath, getPath(key, ".body"), ec);
+	if(ec || !writeEntry(key, url, entry))
+		return;
+
+	add(key, size);
+}
+
+void HttpCache::refresh(const std::string& url, const Entry& entry)
+{
+	const std::string key = getKey(url);
+
+	// a 304 doesn't have to repeat the validators
+	Entry updated = entry;
+	Entry stored;
+	if(readEntry(key, url, stored))
+	{
+		if(updated.etag.empty())
+			updated.etag = stored.etag;
+		if(updated.lastModified.empty())
+			updated.lastModified = stored.lastModified;
+	}
+
+	writeEntry(key, url, updated);
+}
+
+void HttpCache::touch(const std::string& key)
+{
+	// the body's modification time is what we go by after a restart
+	boost::system::error_code ec;
+	fs::last_write_time(getPath(key, ".body"), time(NULL), ec);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	auto it = mIndex.find(key);
+	if(it != mIndex.end())
+		it->second.lastUsed = time(NULL);
+}
+
+void HttpCache::add(const std::string& key, unsigned long long size)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto it = mIndex.find(key);
+	if(it != mIndex.end())
+		mSize -= it->second.size;
+
+	IndexEntry& entry = mIndex[key];
+	entry.size = size;
+	entry.lastUsed = time(NULL);
+	mSize += size;
+
+	trim();
+}
+
+void HttpCache::remove(const std::string& key)
+{
+	boost::system::error_code ec;
+	fs::remove(getPath(key, ".body"), ec);
+	fs::remove(getPath(key, ".meta"), ec);
+
+	auto it = mIndex.find(key);
+	if(it != mIndex.end())
+	{
+		mSize -= it->second.size;
+		mIndex.erase(it);
+	}
+}
+
+void HttpCache::trim()
+{
+	if(mSize <= mMaxSize)
+		return;
+
+	// least recently used first, down to 90% so we don't do this again on the next store
+	std::vector< std::pair<time_t, std::string> > byAge;
+	byAge.reserve(mIndex.size());
+	for(auto it = mIndex.cbegin(); it != mIndex.cend(); it++)
+		byAge.push_back(std::make_pair(it->second.lastUsed, it->first));
+
+	std::sort(byAge.begin(), byAge.end());
+
+	for(auto it = byAge.cbegin(); it != byAge.cend() && mSize > mMaxSize / 10 * 9; it++)
+		remove(it->second);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#ifndef ES_CORE_HTTP_CACHE_H
+#define ES_CORE_HTTP_CACHE_H
+
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+
+//This is a singleton for the on-disk cache of HTTP responses HttpReq uses, kept in ~/.emulationstation/http_cache.
+//Responses are keyed by URL and kept for as long as their Cache-Control max-age says, or Settings "HttpCacheTTL"
+//seconds if the server doesn't say. After that HttpReq revalidates them with their ETag / Last-Modified.
+//The cache is trimmed to Settings "HttpCacheSize" MB (0 turns it off), least recently used first.
+//Safe to use from any thread.
+class HttpCache
+{
+public:
+	struct Entry
+	{
+		Entry() : expires(0) {}
+
+		std::string etag;
+		std::string lastModified;
+		time_t expires;
+
+		inline bool isFresh() const { return time(NULL) < expires; }
+		inline bool canRevalidate() const { return !etag.empty() || !lastModified.empty(); }
+	};
+
+	static HttpCache* getInstance();
+
+	inline bool isEnabled() const { return mMaxSize > 0; }
+
+	// Returns false if nothing is cached for url.
+	bool find(const std::string& url, Entry& entry);
+	bool read(const std::string& url, std::string& body);
+	bool copyTo(const std::string& url, const std::string& path);
+
+	// Fills entry from the raw response headers, returns false if the response must not be cached (Cache-Control: no-store).
+	bool makeEntry(const std::string& headers, Entry& entry) const;
+
+	void store(const std::string& url, const Entry& entry, const std::string& body);
+	void storeFile(const std::string& url, const Entry& entry, const std::string& path); // the response was saved to path
+	void refresh(const std::string& url, const Entry& entry); // a 304 Not Modified came back with these headers
+
+private:
+	static HttpCache* sInstance;
+
+	HttpCache();
+
+	struct IndexEntry
+	{
+		unsigned long long size;
+		time_t lastUsed;
+	};
+
+	static std::string getKey(const std::string& url);
+	std::string getPath(const std::string& key, const char* extension) const;
+
+	bool readEntry(const std::string& key, const std::string& url, Entry& entry) const;
+	bool writeEntry(const std::string& key, const std::string& url, const Entry& entry) const;
+	void touch(const std::string& key); // marks it as just used
+	void add(const std::string& key, unsigned long long size);
+	void remove(const std::string& key);
+	void trim();
+
+	std::mutex mMutex;
+	std::string mDir;
+	unsigned long long mMaxSize; // bytes
+	int mTTL; // seconds
+
+	std::map<std::string, IndexEntry> mIndex; // every cached body by key
+	unsigned long long mSize;
+};
+
+#endif // ES_CORE_HTTP_CACHE_H
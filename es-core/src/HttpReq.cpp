@@ -1,12 +1,131 @@
 #include <iostream>
 #include "HttpReq.h"
+#include "HttpCache.h"
 #include "Log.h"
+#include "Settings.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <SDL.h>
 #include <boost/filesystem.hpp>
 
-CURLM* HttpReq::s_multi_handle = curl_multi_init();
-
 std::map<CURL*, HttpReq*> HttpReq::s_requests;
 
+int HttpReq::s_maxRequestsPerSecond = 0;
+std::map<std::string, HttpReq::Clock::time_point> HttpReq::s_hostNextStart;
+
+namespace
+{
+	const int MAX_POLL_TIME = 1000; // ms, the network thread checks for new work at least this often
+	const size_t MAX_FREE_HANDLES = 16;
+
+	CURLM* sMultiHandle = curl_multi_init(); // only touched by the network thread, apart from curl_multi_wakeup()
+
+	// DNS results and TLS sessions are shared by every request, so talking to the same server again skips the
+	// lookup and a full handshake (open connections are pooled by the multi handle, not by this)
+	std::mutex sShareMutexes[CURL_LOCK_DATA_LAST];
+
+	void lockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr)
+	{
+		sShareMutexes[data].lock();
+	}
+
+	void unlockShare(CURL* handle, curl_lock_data data, void* userptr)
+	{
+		sShareMutexes[data].unlock();
+	}
+
+	CURLSH* createShare()
+	{
+		CURLSH* share = curl_share_init();
+		if(share == NULL)
+			return NULL;
+
+		curl_share_setopt(share, CURLSHOPT_LOCKFUNC, &lockShare);
+		curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, &unlockShare);
+		curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+		return share;
+	}
+
+	CURLSH* sShare = createShare();
+
+	std::mutex sMutex; // guards everything below, each request's mOnNetworkThread and s_hostNextStart
+	std::condition_variable sChanged; // a request finished or the network thread let go of it
+	std::vector<HttpReq*> sWaiting; // not started yet, maybe waiting for their host's rate limit
+	std::vector<HttpReq*> sRemoving; // being destroyed while their transfer is still running
+	std::vector<CURL*> sFreeHandles; // easy handles of finished requests, kept to be reused
+	std::thread sNetworkThread;
+	bool sStopping = false;
+
+	void wakeNetworkThread(CURLM* multi)
+	{
+#if LIBCURL_VERSION_NUM >= 0x074400
+		curl_multi_wakeup(multi);
+#endif
+	}
+
+	void pollNetwork(CURLM* multi, int timeoutMs)
+	{
+#if LIBCURL_VERSION_NUM >= 0x074400
+		curl_multi_poll(multi, NULL, 0, timeoutMs, NULL);
+#else
+		// no way to interrupt curl_multi_wait() from another thread, keep it short; it also returns right away with no transfers
+		int numfds = 0;
+		curl_multi_wait(multi, NULL, 0, std::min(timeoutMs, 20), &numfds);
+		if(numfds == 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(std::min(timeoutMs, 20)));
+#endif
+	}
+
+	// file:// and the like are on disk already, caching them would only push real responses out of the cache
+	bool isHttp(const std::string& url)
+	{
+		const size_t end = url.find("://");
+		if(end == std::string::npos)
+			return true; // curl guesses the protocol, http unless the host says otherwise
+
+		std::string scheme = url.substr(0, end);
+		std::transform(scheme.begin(), scheme.end(), scheme.begin(), ::tolower);
+		return scheme == "http" || scheme == "https";
+	}
+
+	// joins the network thread before the statics it uses go away
+	struct NetworkThreadStopper
+	{
+		~NetworkThreadStopper()
+		{
+			if(!sNetworkThread.joinable())
+				return;
+
+			{
+				std::lock_guard<std::mutex> lock(sMutex);
+				sStopping = true;
+			}
+
+			wakeNetworkThread(sMultiHandle);
+			sNetworkThread.join();
+		}
+	} sNetworkThreadStopper;
+}
+
+void HttpReq::setMaxRequestsPerSecond(int requestsPerSecond)
+{
+	std::lock_guard<std::mutex> lock(sMutex);
+	s_maxRequestsPerSecond = requestsPerSecond;
+	s_hostNextStart.clear();
+}
+
+std::string HttpReq::getHost(const std::string& url)
+{
+	size_t start = url.find("://");
+	start = (start == std::string::npos ? 0 : start + 3);
+	return url.substr(start, url.find('/', start) - start);
+}
+
 std::string HttpReq::urlEncode(const std::string &s)
 {
     const std::string unreserved = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_.~";
@@ -36,10 +155,22 @@ bool HttpReq::isUrl(const std::string& str)
 		(str.find("http://") != std::string::npos || str.find("https://") != std::string::npos || str.find("www.") != std::string::npos));
 }
 
-HttpReq::HttpReq(const std::string& url)
-	: mStatus(REQ_IN_PROGRESS), mHandle(NULL)
+HttpReq::HttpReq(const std::string& url, const std::string& saveAs)
+	: mStatus(REQ_IN_PROGRESS), mHandle(NULL), mOnNetworkThread(false), mUrl(url), mSavePath(saveAs), mHeaders(NULL), mRevalidating(false)
 {
-	mHandle = curl_easy_init();
+	{
+		std::lock_guard<std::mutex> lock(sMutex);
+		if(!sFreeHandles.empty())
+		{
+			mHandle = sFreeHandles.back();
+			sFreeHandles.pop_back();
+		}
+	}
+
+	if(mHandle != NULL)
+		curl_easy_reset(mHandle);
+	else
+		mHandle = curl_easy_init();
 
 	if(mHandle == NULL)
 	{
@@ -102,78 +233,408 @@ HttpReq::HttpReq(const std::string& url)
 		return;
 	}
 
-	//add the handle to our multi
-	CURLMcode merr = curl_multi_add_handle(s_multi_handle, mHandle);
-	if(merr != CURLM_OK)
+	//the rest are optional, a libcurl built without support for them just does without
+	if(sShare)
+		curl_easy_setopt(mHandle, CURLOPT_SHARE, sShare);
+
+	curl_easy_setopt(mHandle, CURLOPT_ACCEPT_ENCODING, ""); // every compression libcurl can decode, e.g. gzip and br
+	curl_easy_setopt(mHandle, CURLOPT_TCP_KEEPALIVE, 1L);
+
+	if(Settings::getInstance()->getBool("Http2"))
 	{
-		mStatus = REQ_IO_ERROR;
-		onError(curl_multi_strerror(merr));
-		return;
+		curl_easy_setopt(mHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+		curl_easy_setopt(mHandle, CURLOPT_PIPEWAIT, 1L); // wait to multiplex over a connection being opened to the same host rather than opening another
+	}else{
+		curl_easy_setopt(mHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+	}
+
+	std::lock_guard<std::mutex> lock(sMutex);
+
+	//take the next free slot for this host, the network thread looks in the cache and starts the transfer then
+	//(file:// URLs have no host and no server to be polite to)
+	mStartTime = Clock::now();
+	if(s_maxRequestsPerSecond > 0 && !getHost(url).empty())
+	{
+		Clock::time_point& next = s_hostNextStart[getHost(url)];
+		if(next > mStartTime)
+			mStartTime = next;
+		next = mStartTime + std::chrono::microseconds(1000000 / s_maxRequestsPerSecond);
 	}
 
-	s_requests[mHandle] = this;
+	sWaiting.push_back(this);
+
+	if(!sNetworkThread.joinable())
+		sNetworkThread = std::thread(&HttpReq::runNetworkThread);
+	else
+		wakeNetworkThread(sMultiHandle);
 }
 
 HttpReq::~HttpReq()
 {
 	if(mHandle)
 	{
-		s_requests.erase(mHandle);
+		{
+			std::unique_lock<std::mutex> lock(sMutex);
+
+			auto waiting = std::find(sWaiting.begin(), sWaiting.end(), this);
+			if(waiting != sWaiting.end())
+			{
+				sWaiting.erase(waiting);
+			}else if(mOnNetworkThread)
+			{
+				// only the network thread may touch the multi handle, and it may be writing to us right now
+				sRemoving.push_back(this);
+				wakeNetworkThread(sMultiHandle);
+				sChanged.wait(lock, [this] { return !mOnNetworkThread; });
+			}
 
-		CURLMcode merr = curl_multi_remove_handle(s_multi_handle, mHandle);
+			// cancelled, don't leave half a file behind or touch the one it was going to replace
+			if(mFile.is_open())
+				closeFile(false);
 
-		if(merr != CURLM_OK)
-			LOG(LogError) << "Error removing curl_easy handle from curl_multi: " << curl_multi_strerror(merr);
+			// keep it around, along with its TLS session, for the next request
+			if(sFreeHandles.size() < MAX_FREE_HANDLES)
+			{
+				sFreeHandles.push_back(mHandle);
+				mHandle = NULL;
+			}
+		}
 
-		curl_easy_cleanup(mHandle);
+		if(mHandle)
+			curl_easy_cleanup(mHandle);
 	}
+
+	if(mHeaders)
+		curl_slist_free_all(mHeaders);
 }
 
-HttpReq::Status HttpReq::status()
+bool HttpReq::prepareTransfer()
 {
-	if(mStatus == REQ_IN_PROGRESS)
+	//a response on disk that's still fresh means no request at all, a stale one we ask the server about
+	HttpCache* cache = HttpCache::getInstance();
+	const bool useCache = isHttp(mUrl) && cache->isEnabled();
+	if(useCache && cache->find(mUrl, mCacheEntry))
 	{
-		int handle_count;
-		CURLMcode merr = curl_multi_perform(s_multi_handle, &handle_count);
-		if(merr != CURLM_OK && merr != CURLM_CALL_MULTI_PERFORM)
+		if(mCacheEntry.isFresh() && loadFromCache())
+		{
+			LOG(LogDebug) << "HttpReq " << mUrl << ": fresh in the cache, not requested";
+			mTiming.fromCache = true;
+			mStatus = REQ_SUCCESS;
+			return false;
+		}
+
+		if(!mCacheEntry.etag.empty())
+			mHeaders = curl_slist_append(mHeaders, ("If-None-Match: " + mCacheEntry.etag).c_str());
+		if(!mCacheEntry.lastModified.empty())
+			mHeaders = curl_slist_append(mHeaders, ("If-Modified-Since: " + mCacheEntry.lastModified).c_str());
+
+		mRevalidating = (mHeaders != NULL);
+		if(mRevalidating)
+			curl_easy_setopt(mHandle, CURLOPT_HTTPHEADER, mHeaders);
+	}
+
+	if(useCache)
+	{
+		curl_easy_setopt(mHandle, CURLOPT_HEADERFUNCTION, &HttpReq::write_header);
+		curl_easy_setopt(mHandle, CURLOPT_HEADERDATA, this);
+	}
+
+	if(!mSavePath.empty())
+	{
+		mFile.open(mSavePath + ".part", std::ios_base::out | std::ios_base::binary);
+		if(!mFile.is_open())
 		{
+			onError("Failed to open file to write. Permission error?");
 			mStatus = REQ_IO_ERROR;
-			onError(curl_multi_strerror(merr));
-			return mStatus;
+			return false;
 		}
+	}
 
-		int msgs_left;
-		CURLMsg* msg;
-		while((msg = curl_multi_info_read(s_multi_handle, &msgs_left)) != nullptr)
+	return true;
+}
+
+bool HttpReq::loadFromCache()
+{
+	if(mSavePath.empty())
+		return HttpCache::getInstance()->read(mUrl, mContent);
+
+	// like a download, so a failed copy doesn't leave a broken file where the old one was
+	const std::string partPath = mSavePath + ".part";
+	boost::system::error_code ec;
+	if(HttpCache::getInstance()->copyTo(mUrl, partPath))
+	{
+		boost::filesystem::rename(partPath, mSavePath, ec);
+		if(!ec)
+			return true;
+	}
+
+	boost::filesystem::remove(partPath, ec);
+	return false;
+}
+
+bool HttpReq::isNotModified()
+{
+	long code = 0;
+	curl_easy_getinfo(mHandle, CURLINFO_RESPONSE_CODE, &code);
+	return code == 304 && mRevalidating;
+}
+
+void HttpReq::updateCache()
+{
+	HttpCache* cache = HttpCache::getInstance();
+
+	// what we have is still good
+	if(isNotModified())
+	{
+		HttpCache::Entry entry;
+		cache->makeEntry(mResponseHeaders, entry);
+		cache->refresh(mUrl, entry);
+
+		if(!loadFromCache())
+		{
+			onError("Cached response went missing");
+			mStatus = REQ_IO_ERROR;
+		}
+
+		mTiming.fromCache = true;
+		return;
+	}
+
+	long code = 0;
+	curl_easy_getinfo(mHandle, CURLINFO_RESPONSE_CODE, &code);
+
+	HttpCache::Entry entry;
+	if(code != 200 || !cache->isEnabled() || !isHttp(mUrl) || !cache->makeEntry(mResponseHeaders, entry))
+		return;
+
+	if(!mSavePath.empty())
+		cache->storeFile(mUrl, entry, mSavePath);
+	else
+		cache->store(mUrl, entry, mContent);
+}
+
+void HttpReq::recordTiming()
+{
+	long connects = 0;
+	curl_easy_getinfo(mHandle, CURLINFO_NAMELOOKUP_TIME, &mTiming.nameLookup);
+	curl_easy_getinfo(mHandle, CURLINFO_CONNECT_TIME, &mTiming.connect);
+	curl_easy_getinfo(mHandle, CURLINFO_APPCONNECT_TIME, &mTiming.tlsHandshake);
+	curl_easy_getinfo(mHandle, CURLINFO_STARTTRANSFER_TIME, &mTiming.firstByte);
+	curl_easy_getinfo(mHandle, CURLINFO_TOTAL_TIME, &mTiming.total);
+#if LIBCURL_VERSION_NUM >= 0x073700
+	curl_off_t downloaded = 0;
+	curl_easy_getinfo(mHandle, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+#else
+	double downloaded = 0;
+	curl_easy_getinfo(mHandle, CURLINFO_SIZE_DOWNLOAD, &downloaded);
+#endif
+	mTiming.downloaded = (long long)downloaded;
+	curl_easy_getinfo(mHandle, CURLINFO_NUM_CONNECTS, &connects);
+	mTiming.reusedConnection = (connects == 0);
+
+	const char* url = NULL;
+	curl_easy_getinfo(mHandle, CURLINFO_EFFECTIVE_URL, &url);
+
+	LOG(LogDebug) << "HttpReq " << (url ? url : "?") << ": " << (int)(mTiming.total * 1000) << "ms total, "
+		<< (int)(mTiming.firstByte * 1000) << "ms to first byte, " << mTiming.downloaded << " bytes, "
+		<< (mTiming.reusedConnection ? "reused connection" : "new connection") << (isNotModified() ? ", not modified" : "");
+}
+
+void HttpReq::runNetworkThread()
+{
+#if LIBCURL_VERSION_NUM >= 0x072B00
+	curl_multi_setopt(sMultiHandle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+
+	std::unique_lock<std::mutex> lock(sMutex);
+
+	while(!sStopping)
+	{
+		// requests that are being destroyed
+		for(auto it = sRemoving.cbegin(); it != sRemoving.cend(); it++)
+		{
+			if(!(*it)->mOnNetworkThread)
+				continue;
+
+			CURLMcode merr = curl_multi_remove_handle(sMultiHandle, (*it)->mHandle);
+			if(merr != CURLM_OK)
+				LOG(LogError) << "Error removing curl_easy handle from curl_multi: " << curl_multi_strerror(merr);
+
+			s_requests.erase((*it)->mHandle);
+			(*it)->mOnNetworkThread = false;
+		}
+
+		if(!sRemoving.empty())
+		{
+			sRemoving.clear();
+			sChanged.notify_all();
+		}
+
+		// requests whose turn has come
+		const Clock::time_point now = Clock::now();
+		Clock::time_point nextStart = now + std::chrono::milliseconds(MAX_POLL_TIME);
+		bool finished = false;
+
+		std::vector<HttpReq*> starting;
+		auto it = sWaiting.begin();
+		while(it != sWaiting.end())
+		{
+			HttpReq* req = *it;
+			if(req->mStartTime > now)
+			{
+				nextStart = std::min(nextStart, req->mStartTime);
+				it++;
+				continue;
+			}
+
+			it = sWaiting.erase(it);
+			req->mOnNetworkThread = true;
+			starting.push_back(req);
+		}
+
+		// the cache lookup and opening the output file go to disk, the UI thread needs sMutex for every request it makes
+		if(!starting.empty())
+		{
+			lock.unlock();
+			for(auto req = starting.cbegin(); req != starting.cend(); req++)
+				(*req)->prepareTransfer();
+			lock.lock();
+		}
+
+		for(auto reqIt = starting.cbegin(); reqIt != starting.cend(); reqIt++)
 		{
-			if(msg->msg == CURLMSG_DONE)
+			HttpReq* req = *reqIt;
+			auto removing = std::find(sRemoving.begin(), sRemoving.end(), req);
+
+			//add the handle to our multi
+			if(req->mStatus == REQ_IN_PROGRESS && removing == sRemoving.end())
 			{
-				HttpReq* req = s_requests[msg->easy_handle];
-				
-				if(req == NULL)
+				CURLMcode merr = curl_multi_add_handle(sMultiHandle, req->mHandle);
+				if(merr == CURLM_OK)
 				{
-					LOG(LogError) << "Cannot find easy handle!";
+					s_requests[req->mHandle] = req;
 					continue;
 				}
 
-				if(msg->data.result == CURLE_OK)
-				{
-					req->mStatus = REQ_SUCCESS;
-				}else{
-					req->mStatus = REQ_IO_ERROR;
-					req->onError(curl_easy_strerror(msg->data.result));
-				}
+				req->onError(curl_multi_strerror(merr));
+				req->mStatus = REQ_IO_ERROR;
+			}
+
+			// answered from the cache, failed, or destroyed while it was being prepared
+			req->mOnNetworkThread = false;
+			if(removing != sRemoving.end())
+				sRemoving.erase(removing);
+			finished = true;
+		}
+
+		// transfer whatever is ready, requests in the multi handle can't be destroyed until we take them out
+		lock.unlock();
+		int handle_count;
+		CURLMcode merr = curl_multi_perform(sMultiHandle, &handle_count);
+		if(merr != CURLM_OK && merr != CURLM_CALL_MULTI_PERFORM)
+			LOG(LogError) << "curl_multi_perform failed: " << curl_multi_strerror(merr);
+		lock.lock();
+
+		int msgs_left;
+		CURLMsg* msg;
+		while((msg = curl_multi_info_read(sMultiHandle, &msgs_left)) != nullptr)
+		{
+			if(msg->msg != CURLMSG_DONE)
+				continue;
+
+			auto found = s_requests.find(msg->easy_handle);
+			if(found == s_requests.cend())
+			{
+				LOG(LogError) << "Cannot find easy handle!";
+				continue;
+			}
+
+			HttpReq* req = found->second;
+			const CURLcode result = msg->data.result;
+			s_requests.erase(found);
+			curl_multi_remove_handle(sMultiHandle, req->mHandle);
+
+			// saving the file and the cache copies go to disk, the request can't be destroyed meanwhile as it's still ours
+			lock.unlock();
+			req->recordTiming();
+
+			if(req->mFile.is_open())
+				req->closeFile(result == CURLE_OK);
+
+			if(result == CURLE_OK && req->mStatus == REQ_IN_PROGRESS)
+				req->updateCache();
+
+			if(result != CURLE_OK)
+			{
+				req->onError(curl_easy_strerror(result));
+				req->mStatus = REQ_IO_ERROR;
+			}else if(req->mStatus == REQ_IN_PROGRESS) // closeFile() can fail
+			{
+				req->mStatus = REQ_SUCCESS;
 			}
+
+			lock.lock();
+			req->mOnNetworkThread = false;
+
+			// its destructor returns as soon as it sees mOnNetworkThread cleared, don't look at it again on the next pass
+			sRemoving.erase(std::remove(sRemoving.begin(), sRemoving.end(), req), sRemoving.end());
+			finished = true;
+		}
+
+		if(finished)
+		{
+			sChanged.notify_all();
+
+			SDL_Event event = {};
+			event.type = SDL_USEREVENT;
+			SDL_PushEvent(&event);
 		}
+
+		// sleep until a socket is ready, curl needs to run a timeout, a rate limited request is due or something is queued
+		const int timeout = (int)std::chrono::duration_cast<std::chrono::milliseconds>(nextStart - Clock::now()).count();
+		lock.unlock();
+		pollNetwork(sMultiHandle, std::max(timeout, 0));
+		lock.lock();
 	}
+}
 
-	return mStatus;
+const std::string& HttpReq::getContent() const
+{
+	assert(mStatus == REQ_SUCCESS);
+	return mContent;
 }
 
-std::string HttpReq::getContent() const
+std::string HttpReq::takeContent()
 {
 	assert(mStatus == REQ_SUCCESS);
-	return mContent.str();
+	return std::move(mContent);
+}
+
+void HttpReq::closeFile(bool keep)
+{
+	mFile.close();
+	if(keep && mFile.fail())
+	{
+		onError("Failed to save file. Disk full?");
+		mStatus = REQ_IO_ERROR;
+		keep = false;
+	}
+
+	// the response went next to mSavePath, so whatever was there stays until a new one has arrived in full
+	// (a 304 has no body, the file comes from the cache)
+	const std::string partPath = mSavePath + ".part";
+	boost::system::error_code ec;
+	if(keep && !isNotModified())
+	{
+		boost::filesystem::rename(partPath, mSavePath, ec);
+		if(!ec)
+			return;
+
+		onError("Failed to save file. Permission error?");
+		mStatus = REQ_IO_ERROR;
+	}
+
+	boost::filesystem::remove(partPath, ec);
 }
 
 void HttpReq::onError(const char* msg)
@@ -191,10 +652,46 @@ std::string HttpReq::getErrorMsg()
 //return value is number of elements successfully read
 size_t HttpReq::write_content(void* buff, size_t size, size_t nmemb, void* req_ptr)
 {
-	std::stringstream& ss = ((HttpReq*)req_ptr)->mContent;
-	ss.write((char*)buff, size * nmemb);
+	HttpReq* req = (HttpReq*)req_ptr;
+	const size_t length = size * nmemb;
+
+	if(req->mFile.is_open())
+	{
+		req->mFile.write((char*)buff, length);
+		return req->mFile.fail() ? 0 : length; // anything but length aborts the transfer
+	}
+
+	// one allocation for the whole response when the server says how big it is - unless it came compressed,
+	// Content-Length is then the compressed size and this only saves the first few reallocations
+	if(req->mContent.empty())
+	{
+#if LIBCURL_VERSION_NUM >= 0x073700
+		curl_off_t contentLength = -1;
+		curl_easy_getinfo(req->mHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength);
+#else
+		double contentLength = -1;
+		curl_easy_getinfo(req->mHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &contentLength);
+#endif
+		if(contentLength > 0)
+			req->mContent.reserve((size_t)contentLength);
+	}
+
+	req->mContent.append((char*)buff, length);
+	return length;
+}
+
+//used as a curl callback, called once for each header line
+size_t HttpReq::write_header(char* buff, size_t size, size_t nitems, void* req_ptr)
+{
+	HttpReq* req = (HttpReq*)req_ptr;
+	const size_t length = size * nitems;
+
+	// the status line of a new response, after a redirect for example
+	if(length >= 5 && strncmp(buff, "HTTP/", 5) == 0)
+		req->mResponseHeaders.clear();
 
-	return nmemb;
+	req->mResponseHeaders.append(buff, length);
+	return length;
 }
 
 //used as a curl callback
@@ -3,13 +3,19 @@
 #define ES_CORE_HTTP_REQ_H
 
 #include <curl/curl.h>
+#include "HttpCache.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
 #include <sstream>
 #include <map>
 
 /* Usage:
  * HttpReq myRequest("www.google.com", "/index.html");
- * //for blocking behavior: while(myRequest.status() == HttpReq::REQ_IN_PROGRESS);
- * //for non-blocking behavior: check if(myRequest.status() != HttpReq::REQ_IN_PROGRESS) in some sort of update method
+ * //check if(myRequest.status() != HttpReq::REQ_IN_PROGRESS) in some sort of update method
+ *
+ * //transfers run on a network thread shared by all requests, so they make progress no matter how often status() is called;
+ * //an SDL_USEREVENT is pushed whenever one finishes, to wake up a main loop waiting for events
  * 
  * //once one of those completes, the request is ready
  * if(myRequest.status() != REQ_SUCCESS)
@@ -19,14 +25,16 @@
  *    return;
  * }
  *
- * std::string content = myRequest.getContent();
+ * const std::string& content = myRequest.getContent();
  * //process contents...
 */
 
 class HttpReq
 {
 public:
-	HttpReq(const std::string& url);
+	// If saveAs isn't empty the response is written to saveAs + ".part" as it arrives instead of being kept in memory,
+	// and renamed to saveAs once it's complete, so a request that fails leaves a file already there alone.
+	HttpReq(const std::string& url, const std::string& saveAs = "");
 
 	~HttpReq();
 
@@ -40,32 +48,79 @@ public:
 		REQ_INVALID_RESPONSE	//the HTTP response was invalid
 	};
 
-	Status status(); //process any received data and return the status afterwards
+	inline Status status() const { return mStatus; }
 
 	std::string getErrorMsg();
 
-	std::string getContent() const; // mStatus must be REQ_SUCCESS
+	const std::string& getContent() const; // mStatus must be REQ_SUCCESS, valid until the request is destroyed or takeContent() is called
+	std::string takeContent(); // as above, but moves the response out instead of copying it
+
+	// How long each phase of the transfer took, measured from its start, in seconds. Filled in once it is done.
+	struct Timing
+	{
+		Timing() : nameLookup(0), connect(0), tlsHandshake(0), firstByte(0), total(0), downloaded(0), reusedConnection(false), fromCache(false) {}
+
+		double nameLookup;
+		double connect;
+		double tlsHandshake; // 0 for plain HTTP
+		double firstByte;
+		double total;
+		long long downloaded; // bytes
+		bool reusedConnection; // no DNS lookup, connect or handshake was needed
+		bool fromCache; // the response came from HttpCache, either without asking the server or after a 304 Not Modified
+	};
+
+	inline const Timing& getTiming() const { return mTiming; }
 
 	static std::string urlEncode(const std::string &s);
 	static bool isUrl(const std::string& s);
 
+	// Spaces out the start of requests to the same host so no more than this many begin per second (0 is no limit).
+	// Requests made while their host is busy wait in REQ_IN_PROGRESS until their turn comes up.
+	static void setMaxRequestsPerSecond(int requestsPerSecond);
+
 private:
+	typedef std::chrono::steady_clock Clock;
+
+	static std::string getHost(const std::string& url);
+	static void runNetworkThread(); // owns the curl multi handle: starts queued requests, runs transfers and completes requests
+
+
 	static size_t write_content(void* buff, size_t size, size_t nmemb, void* req_ptr);
+	static size_t write_header(char* buff, size_t size, size_t nitems, void* req_ptr);
 	//static int update_progress(void* req_ptr, double dlTotal, double dlNow, double ulTotal, double ulNow);
 
 	//god dammit libcurl why can't you have some way to check the status of an individual handle
 	//why do I have to handle ALL messages at once
-	static std::map<CURL*, HttpReq*> s_requests;
+	static std::map<CURL*, HttpReq*> s_requests; // only touched by the network thread
 
-	static CURLM* s_multi_handle;
+	static int s_maxRequestsPerSecond;
+	static std::map<std::string, Clock::time_point> s_hostNextStart; // earliest time the next request to each host may start
 
 	void onError(const char* msg);
+	void recordTiming(); // on the network thread, when the transfer is done
+	bool prepareTransfer(); // on the network thread before the transfer starts, false if the cache answered or it failed
+	void closeFile(bool keep);
+	bool loadFromCache(); // into mContent, or copied to mSavePath
+	bool isNotModified(); // the server answered 304 to our revalidation, once the transfer is done
+	void updateCache(); // on the network thread, once the transfer is done
 
 	CURL* mHandle;
 
-	Status mStatus;
+	std::atomic<Status> mStatus; // set by the network thread once the transfer is done
+	bool mOnNetworkThread; // being prepared, transferred or completed by the network thread, guarded by its mutex
+	Clock::time_point mStartTime;
+	Timing mTiming;
+
+	std::string mUrl;
+	std::string mContent; // reserved from Content-Length when the first data arrives
+	std::string mSavePath;
+	std::ofstream mFile; // open while the response is being written to mSavePath
 
-	std::stringstream mContent;
+	HttpCache::Entry mCacheEntry;
+	curl_slist* mHeaders; // request headers
+	std::string mResponseHeaders; // raw, of the last response if there were redirects
+	bool mRevalidating; // asked the server whether mCacheEntry is still good
 	std::string mErrorMsg;
 };
 
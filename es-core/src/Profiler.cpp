@@ -0,0 +1,203 @@
+#include "Profiler.h"
+#include <chrono>
+#include <map>
+#include <algorithm>
+#include <fstream>
+#include <typeinfo>
+#include <typeindex>
+#include "GuiComponent.h"
+#include "Log.h"
+#include "platform.h"
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#include <stdlib.h>
+#endif
+
+bool Profiler::sEnabled = false;
+std::deque<Profiler::Frame> Profiler::sFrames;
+std::vector<Profiler::OpenEvent> Profiler::sOpenEvents;
+
+long long Profiler::now()
+{
+	static const auto epoch = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+	sEnabled = enabled;
+
+	sFrames.clear();
+	sOpenEvents.clear();
+}
+
+void Profiler::frameStart()
+{
+	if(!sEnabled)
+		return;
+
+	const long long time = now();
+
+	if(sFrames.size())
+		sFrames.back().end = time;
+
+	Frame frame;
+	frame.start = time;
+	frame.end = time;
+	sFrames.push_back(frame);
+
+	while(sFrames.size() > MAX_FRAMES)
+		sFrames.pop_front();
+}
+
+void Profiler::begin(const char* name, const char* category)
+{
+	OpenEvent ev = { name, category, now(), 0 };
+	sOpenEvents.push_back(ev);
+}
+
+void Profiler::end()
+{
+	// setEnabled() may have been called while this scope was open
+	if(sOpenEvents.empty())
+		return;
+
+	const OpenEvent& open = sOpenEvents.back();
+	const long long duration = now() - open.start;
+
+	if(sFrames.empty())
+		frameStart();
+
+	Event ev = { open.name, open.category, open.start, (int)duration, (int)(duration - open.childTime) };
+	sFrames.back().events.push_back(ev);
+
+	sOpenEvents.pop_back();
+	if(sOpenEvents.size())
+		sOpenEvents.back().childTime += duration;
+}
+
+const char* Profiler::getComponentName(const GuiComponent* component)
+{
+	// demangling is slow, so only do it once per type
+	static std::map<std::type_index, std::string> names;
+
+	const std::type_info& type = typeid(*component);
+	auto it = names.find(type);
+	if(it != names.cend())
+		return it->second.c_str();
+
+	std::string name = type.name();
+#ifdef __GNUG__
+	int status = 0;
+	char* demangled = abi::__cxa_demangle(type.name(), NULL, NULL, &status);
+	if(status == 0 && demangled != NULL)
+		name = demangled;
+	free(demangled);
+#endif
+
+	return names.insert(std::make_pair(std::type_index(type), name)).first->second.c_str();
+}
+
+std::vector<float> Profiler::getFrameTimes()
+{
+	std::vector<float> times;
+	if(sFrames.size() < 2)
+		return times;
+
+	times.reserve(sFrames.size() - 1);
+	for(auto it = sFrames.cbegin(); it != sFrames.cend() - 1; it++)
+		times.push_back((it->end - it->start) / 1000.0f);
+
+	return times;
+}
+
+std::vector<Profiler::Offender> Profiler::getTopOffenders(unsigned int count)
+{
+	std::vector<Offender> offenders;
+	if(sFrames.empty())
+		return offenders;
+
+	// names are either string literals or owned by getComponentName(), so the pointer identifies the event
+	std::map<const char*, Offender> totals;
+	for(auto frame = sFrames.cbegin(); frame != sFrames.cend(); frame++)
+	{
+		for(auto ev = frame->events.cbegin(); ev != frame->events.cend(); ev++)
+		{
+			auto it = totals.find(ev->name);
+			if(it == totals.cend())
+			{
+				Offender offender = { ev->name, ev->category, 0.0f };
+				it = totals.insert(std::make_pair(ev->name, offender)).first;
+			}
+
+			it->second.selfTime += ev->selfDuration / 1000.0f;
+		}
+	}
+
+	for(auto it = totals.begin(); it != totals.end(); it++)
+	{
+		it->second.selfTime /= sFrames.size();
+		offenders.push_back(it->second);
+	}
+
+	std::sort(offenders.begin(), offenders.end(), [](const Offender& a, const Offender& b) { return a.selfTime > b.selfTime; });
+
+	if(offenders.size() > count)
+		offenders.resize(count);
+
+	return offenders;
+}
+
+std::string Profiler::getTracePath()
+{
+	return getHomePath() + "/.emulationstation/es_trace.json";
+}
+
+static std::string escapeJSON(const char* str)
+{
+	std::string out;
+	for(const char* c = str; *c != '\0'; c++)
+	{
+		if(*c == '"' || *c == '\\')
+			out += '\\';
+
+		out += *c;
+	}
+	return out;
+}
+
+bool Profiler::writeTrace(const std::string& path)
+{
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc);
+	if(!file.is_open())
+	{
+		LOG(LogError) << "Could not write profiler trace to " << path;
+		return false;
+	}
+
+	file << "{\"traceEvents\":[";
+
+	bool first = true;
+	for(auto frame = sFrames.cbegin(); frame != sFrames.cend(); frame++)
+	{
+		// the last frame is still in progress
+		if(frame->end > frame->start)
+		{
+			file << (first ? "\n" : ",\n") << "{\"name\":\"frame\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":" << frame->start << ",\"dur\":" << (frame->end - frame->start) << "}";
+			first = false;
+		}
+
+		for(auto ev = frame->events.cbegin(); ev != frame->events.cend(); ev++)
+		{
+			file << (first ? "\n" : ",\n") << "{\"name\":\"" << escapeJSON(ev->name) << "\",\"cat\":\"" << ev->category << "\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":" << ev->start << ",\"dur\":" << ev->duration << "}";
+			first = false;
+		}
+	}
+
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	file.close();
+
+	LOG(LogInfo) << "Wrote profiler trace of " << sFrames.size() << " frames to " << path;
+	return true;
+}
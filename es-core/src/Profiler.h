@@ -0,0 +1,84 @@
+#pragma once
+#ifndef ES_CORE_PROFILER_H
+#define ES_CORE_PROFILER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+
+class GuiComponent;
+
+//Collects per-frame timing samples for the debug profiler overlay (toggled with Ctrl-P when --debug is set).
+//Nothing is recorded while the profiler is disabled, so a Scope costs a single bool check.
+class Profiler
+{
+public:
+	struct Event
+	{
+		const char* name;
+		const char* category;
+		long long start; // microseconds since the profiler was first used
+		int duration; // microseconds, including nested events
+		int selfDuration; // microseconds, excluding nested events
+	};
+
+	struct Offender
+	{
+		const char* name;
+		const char* category;
+		float selfTime; // average milliseconds per frame
+	};
+
+	//Records an event that lasts for the lifetime of this object.
+	class Scope
+	{
+	public:
+		inline Scope(const char* name, const char* category) : mActive(sEnabled) { if(mActive) begin(name, category); }
+		inline Scope(const GuiComponent* component, const char* category) : mActive(sEnabled) { if(mActive) begin(getComponentName(component), category); }
+		inline ~Scope() { if(mActive) end(); }
+
+	private:
+		bool mActive;
+	};
+
+	static inline bool isEnabled() { return sEnabled; }
+	static void setEnabled(bool enabled);
+
+	static void frameStart(); // marks the start of a new frame, called by Window::update()
+
+	static std::vector<float> getFrameTimes(); // in milliseconds, oldest first, the frame in progress is not included
+	static std::vector<Offender> getTopOffenders(unsigned int count); // sorted by self time, highest first
+
+	static std::string getTracePath();
+	static bool writeTrace(const std::string& path); // writes the recorded frames as a Chrome trace (chrome://tracing)
+
+	static const unsigned int MAX_FRAMES = 300;
+
+private:
+	struct Frame
+	{
+		long long start;
+		long long end;
+		std::vector<Event> events;
+	};
+
+	struct OpenEvent
+	{
+		const char* name;
+		const char* category;
+		long long start;
+		long long childTime;
+	};
+
+	static void begin(const char* name, const char* category);
+	static void end();
+
+	static long long now();
+	static const char* getComponentName(const GuiComponent* component);
+
+	static bool sEnabled;
+	static std::deque<Frame> sFrames;
+	static std::vector<OpenEvent> sOpenEvents;
+};
+
+#endif // ES_CORE_PROFILER_H
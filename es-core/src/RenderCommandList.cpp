@@ -0,0 +1,277 @@
+#include "RenderCommandList.h"
+#include "Log.h"
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+	// handles given out by Renderer::createTexture() -> OpenGL texture names, only touched by the thread executing commands
+	std::unordered_map<unsigned int, GLuint> sTextures;
+
+	const size_t NO_DATA = (size_t)-1;
+
+	// lists are recycled, so anything a frame needed past this is freed again rather than kept by the list for good
+	// (a single texture upload can be several MB)
+	const size_t MAX_KEPT_BYTES = 1024 * 1024;
+	const size_t MAX_KEPT_FLOATS = 256 * 1024;
+
+	size_t getPixelSize(GLenum format)
+	{
+		return format == GL_ALPHA ? 1 : 4;
+	}
+}
+
+void RenderCommandList::clear()
+{
+	mCommands.clear();
+
+	if(mFloats.capacity() > MAX_KEPT_FLOATS)
+		std::vector<float>().swap(mFloats);
+	else
+		mFloats.clear();
+
+	if(mBytes.capacity() > MAX_KEPT_BYTES)
+		std::vector<GLubyte>().swap(mBytes);
+	else
+		mBytes.clear();
+}
+
+size_t RenderCommandList::addBytes(const void* data, size_t length)
+{
+	if(data == NULL)
+		return NO_DATA;
+
+	const size_t offset = mBytes.size();
+	mBytes.resize(offset + length);
+	memcpy(mBytes.data() + offset, data, length);
+	return offset;
+}
+
+size_t RenderCommandList::addFloats(const float* data, size_t length)
+{
+	const size_t offset = mFloats.size();
+	mFloats.insert(mFloats.end(), data, data + length);
+	return offset;
+}
+
+void RenderCommandList::createTexture(unsigned int texture, GLenum format, GLint minFilter, GLint wrap, unsigned int width, unsigned int height, const void* data)
+{
+	Command cmd = {};
+	cmd.type = CREATE_TEXTURE;
+	cmd.texture = texture;
+	cmd.format = format;
+	cmd.param = minFilter;
+	cmd.wrap = wrap;
+	cmd.rect[2] = width;
+	cmd.rect[3] = height;
+	cmd.byteOffset = addBytes(data, width * height * getPixelSize(format));
+	mCommands.push_back(cmd);
+}
+
+void RenderCommandList::updateTexture(unsigned int texture, GLenum format, int x, int y, unsigned int width, unsigned int height, const void* data)
+{
+	Command cmd = {};
+	cmd.type = UPDATE_TEXTURE;
+	cmd.texture = texture;
+	cmd.format = format;
+	cmd.rect[0] = x;
+	cmd.rect[1] = y;
+	cmd.rect[2] = width;
+	cmd.rect[3] = height;
+	cmd.byteOffset = addBytes(data, width * height * getPixelSize(format));
+	mCommands.push_back(cmd);
+}
+
+void RenderCommandList::destroyTexture(unsigned int texture)
+{
+	Command cmd = {};
+	cmd.type = DESTROY_TEXTURE;
+	cmd.texture = texture;
+	mCommands.push_back(cmd);
+}
+
+void RenderCommandList::setMatrix(const float* matrix)
+{
+	Command cmd = {};
+	cmd.type = SET_MATRIX;
+	cmd.floatOffset = addFloats(matrix, 16);
+	mCommands.push_back(cmd);
+}
+
+void RenderCommandList::setClipRect(const int* box)
+{
+	Command cmd = {};
+	cmd.type = SET_CLIP_RECT;
+	if(box)
+		memcpy(cmd.rect, box, sizeof(cmd.rect));
+	else
+		cmd.rect[2] = -1;
+	mCommands.push_back(cmd);
+}
+
+void RenderCommandList::drawTriangles(unsigned int texture, const float* vertices, const GLubyte* colors, unsigned int count, GLenum blendSrc, GLenum blendDst)
+{
+	Command cmd = {};
+	cmd.type = DRAW_TRIANGLES;
+	cmd.texture = texture;
+	cmd.format = blendSrc;
+	cmd.param = blendDst;
+	cmd.count = count;
+	cmd.floatOffset = addFloats(vertices, count * 4);
+	cmd.byteOffset = addBytes(colors, count * 4);
+	mCommands.push_back(cmd);
+}
+
+void RenderCommandList::drawLines(const float* points, const GLubyte* colors, unsigned int count)
+{
+	Command cmd = {};
+	cmd.type = DRAW_LINES;
+	cmd.count = count;
+	cmd.floatOffset = addFloats(points, count * 2);
+	cmd.byteOffset = addBytes(colors, count * 4);
+	mCommands.push_back(cmd);
+}
+
+void RenderCommandList::execute(bool draw) const
+{
+	for(auto it = mCommands.cbegin(); it != mCommands.cend(); it++)
+	{
+		const Command& cmd = *it;
+		const GLvoid* bytes = (cmd.byteOffset != NO_DATA ? mBytes.data() + cmd.byteOffset : NULL);
+
+		switch(cmd.type)
+		{
+		case CREATE_TEXTURE:
+			{
+				GLuint id;
+				glGenTextures(1, &id);
+				glBindTexture(GL_TEXTURE_2D, id);
+
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, cmd.param);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, cmd.wrap);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, cmd.wrap);
+
+				glTexImage2D(GL_TEXTURE_2D, 0, cmd.format, cmd.rect[2], cmd.rect[3], 0, cmd.format, GL_UNSIGNED_BYTE, bytes);
+				glBindTexture(GL_TEXTURE_2D, 0);
+
+				sTextures[cmd.texture] = id;
+			}
+			break;
+
+		case UPDATE_TEXTURE:
+			{
+				auto texture = sTextures.find(cmd.texture);
+				if(texture == sTextures.cend())
+				{
+					LOG(LogError) << "Tried to update texture " << cmd.texture << ", which doesn't exist!";
+					break;
+				}
+
+				glBindTexture(GL_TEXTURE_2D, texture->second);
+				glTexSubImage2D(GL_TEXTURE_2D, 0, cmd.rect[0], cmd.rect[1], cmd.rect[2], cmd.rect[3], cmd.format, GL_UNSIGNED_BYTE, bytes);
+				glBindTexture(GL_TEXTURE_2D, 0);
+			}
+			break;
+
+		case DESTROY_TEXTURE:
+			{
+				auto texture = sTextures.find(cmd.texture);
+				if(texture != sTextures.cend())
+				{
+					glDeleteTextures(1, &texture->second);
+					sTextures.erase(texture);
+				}
+			}
+			break;
+
+		case SET_MATRIX:
+			if(draw)
+				glLoadMatrixf(&mFloats[cmd.floatOffset]);
+			break;
+
+		case SET_CLIP_RECT:
+			if(!draw)
+				break;
+
+			if(cmd.rect[2] < 0)
+			{
+				glDisable(GL_SCISSOR_TEST);
+			}else{
+				glScissor(cmd.rect[0], cmd.rect[1], cmd.rect[2], cmd.rect[3]);
+				glEnable(GL_SCISSOR_TEST);
+			}
+			break;
+
+		case DRAW_TRIANGLES:
+			{
+				if(!draw)
+					break;
+
+				GLuint textureId = 0;
+				if(cmd.texture != 0)
+				{
+					auto texture = sTextures.find(cmd.texture);
+					if(texture == sTextures.cend())
+						break; // destroyed before it got drawn
+
+					textureId = texture->second;
+				}
+
+				const float* vertices = &mFloats[cmd.floatOffset];
+
+				glEnable(GL_BLEND);
+				glBlendFunc(cmd.format, cmd.param);
+				glEnableClientState(GL_VERTEX_ARRAY);
+				glEnableClientState(GL_COLOR_ARRAY);
+				glVertexPointer(2, GL_FLOAT, sizeof(float) * 4, vertices);
+				glColorPointer(4, GL_UNSIGNED_BYTE, 0, bytes);
+
+				if(textureId)
+				{
+					glBindTexture(GL_TEXTURE_2D, textureId);
+					glEnable(GL_TEXTURE_2D);
+					glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+					glTexCoordPointer(2, GL_FLOAT, sizeof(float) * 4, vertices + 2);
+				}
+
+				glDrawArrays(GL_TRIANGLES, 0, cmd.count);
+
+				if(textureId)
+				{
+					glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+					glDisable(GL_TEXTURE_2D);
+				}
+
+				glDisableClientState(GL_VERTEX_ARRAY);
+				glDisableClientState(GL_COLOR_ARRAY);
+				glDisable(GL_BLEND);
+			}
+			break;
+
+		case DRAW_LINES:
+			if(!draw)
+				break;
+
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			glEnableClientState(GL_VERTEX_ARRAY);
+			glEnableClientState(GL_COLOR_ARRAY);
+
+			glVertexPointer(2, GL_FLOAT, 0, &mFloats[cmd.floatOffset]);
+			glColorPointer(4, GL_UNSIGNED_BYTE, 0, bytes);
+
+			glDrawArrays(GL_LINES, 0, cmd.count);
+
+			glDisable(GL_BLEND);
+			glDisableClientState(GL_VERTEX_ARRAY);
+			glDisableClientState(GL_COLOR_ARRAY);
+			break;
+		}
+	}
+}
+
+void RenderCommandList::resetTextures()
+{
+	sTextures.clear();
+}
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef ES_CORE_RENDER_COMMAND_LIST_H
+#define ES_CORE_RENDER_COMMAND_LIST_H
+
+#include <vector>
+#include "platform.h"
+#include GLHEADER
+
+// Everything the Renderer is asked to do during a frame, recorded on the thread running the UI so it can be replayed
+// on the thread that owns the OpenGL context (see Renderer_init_sdlgl.cpp). Vertex, color and pixel data are copied in,
+// so callers can reuse or free their buffers as soon as a call returns.
+class RenderCommandList
+{
+public:
+	void clear();
+	inline bool empty() const { return mCommands.empty(); }
+
+	void createTexture(unsigned int texture, GLenum format, GLint minFilter, GLint wrap, unsigned int width, unsigned int height, const void* data);
+	void updateTexture(unsigned int texture, GLenum format, int x, int y, unsigned int width, unsigned int height, const void* data);
+	void destroyTexture(unsigned int texture);
+
+	void setMatrix(const float* matrix);
+	void setClipRect(const int* box); // NULL disables clipping
+	void drawTriangles(unsigned int texture, const float* vertices, const GLubyte* colors, unsigned int count, GLenum blendSrc, GLenum blendDst);
+	void drawLines(const float* points, const GLubyte* colors, unsigned int count);
+
+	// Must be called with the OpenGL context current. If draw is false only texture commands are run, for frames that are
+	// skipped because a newer one is already waiting.
+	void execute(bool draw) const;
+
+	// Forgets every texture without deleting it, for when the context they belonged to is gone.
+	static void resetTextures();
+
+private:
+	enum CommandType
+	{
+		CREATE_TEXTURE,
+		UPDATE_TEXTURE,
+		DESTROY_TEXTURE,
+		SET_MATRIX,
+		SET_CLIP_RECT,
+		DRAW_TRIANGLES,
+		DRAW_LINES
+	};
+
+	struct Command
+	{
+		CommandType type;
+		unsigned int texture;
+		GLenum format; // texture format, or blend source factor for DRAW_TRIANGLES
+		GLenum param; // minification filter for CREATE_TEXTURE, blend destination factor for DRAW_TRIANGLES
+		GLint wrap;
+		int rect[4]; // texture region or clip rect (x, y, w, h)
+		unsigned int count; // vertices
+		size_t floatOffset; // into mFloats
+		size_t byteOffset; // into mBytes, (size_t)-1 if there is no data
+	};
+
+	size_t addBytes(const void* data, size_t length);
+	size_t addFloats(const float* data, size_t length);
+
+	std::vector<Command> mCommands;
+	std::vector<float> mFloats; // matrices and vertices
+	std::vector<GLubyte> mBytes; // colors and pixels
+};
+
+namespace Renderer
+{
+	RenderCommandList& getCommandList(); // the list the current frame is being recorded into
+}
+
+#endif // ES_CORE_RENDER_COMMAND_LIST_H
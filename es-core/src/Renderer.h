@@ -14,6 +14,8 @@ class Font;
 //The Renderer provides several higher-level functions for drawing (rectangles, text, etc.).
 //Renderer_draw_gl.cpp has most of the higher-level functions and wrappers.
 //Renderer_init_*.cpp has platform-specific renderer initialziation/deinitialziation code.  (e.g. the Raspberry Pi sets up dispmanx/OpenGL ES)
+//Nothing here calls OpenGL directly: calls are recorded into a RenderCommandList and carried out on the render thread
+//when the frame is handed over with swapBuffers(), so only the render thread ever touches the OpenGL context.
 namespace Renderer
 {
 	bool init(int w, int h);
@@ -25,7 +27,7 @@ namespace Renderer
 	void buildGLColorArray(GLubyte* ptr, unsigned int color, unsigned int vertCount);
 
 	//graphics commands
-	void swapBuffers();
+	void swapBuffers(); // hands the recorded frame to the render thread, waits a bounded time if it's still busy with the last one
 
 	void pushClipRect(Eigen::Vector2i pos, Eigen::Vector2i dim);
 	void popClipRect();
@@ -35,6 +37,17 @@ namespace Renderer
 
 	void drawRect(int x, int y, int w, int h, unsigned int color, GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
 	void drawRect(float x, float y, float w, float h, unsigned int color, GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
+
+	// vertices are interleaved x, y, u, v and colors are 4 bytes per vertex, both are copied; texture 0 draws untextured
+	void drawTriangles(unsigned int texture, const float* vertices, const GLubyte* colors, unsigned int count,
+		GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
+	void drawLines(const float* points, const GLubyte* colors, unsigned int count); // points are x, y pairs
+
+	// Textures are referred to by handles, the OpenGL texture behind one only exists on the render thread.
+	// format is GL_RGBA or GL_ALPHA, data may be NULL and is copied otherwise.
+	unsigned int createTexture(GLenum format, GLint minFilter, bool tile, unsigned int width, unsigned int height, const void* data);
+	void updateTexture(unsigned int texture, GLenum format, int x, int y, unsigned int width, unsigned int height, const void* data);
+	void destroyTexture(unsigned int texture);
 }
 
 #endif // ES_CORE_RENDERER_H
@@ -7,9 +7,11 @@
 #include "Log.h"
 #include <stack>
 #include "Util.h"
+#include "RenderCommandList.h"
 
 namespace Renderer {
 	std::stack<Eigen::Vector4i> clipStack;
+	unsigned int nextTexture = 1;
 
 	void setColor4bArray(GLubyte* array, unsigned int color)
 	{
@@ -63,8 +65,7 @@ namespace Renderer {
 			box[3] = 0;
 
 		clipStack.push(box);
-		glScissor(box[0], box[1], box[2], box[3]);
-		glEnable(GL_SCISSOR_TEST);
+		getCommandList().setClipRect(box.data());
 	}
 
 	void popClipRect()
@@ -77,12 +78,9 @@ namespace Renderer {
 
 		clipStack.pop();
 		if(clipStack.empty())
-		{
-			glDisable(GL_SCISSOR_TEST);
-		}else{
-			Eigen::Vector4i top = clipStack.top();
-			glScissor(top[0], top[1], top[2], top[3]);
-		}
+			getCommandList().setClipRect(NULL);
+		else
+			getCommandList().setClipRect(clipStack.top().data());
 	}
 
 	void drawRect(float x, float y, float w, float h, unsigned int color, GLenum blend_sfactor, GLenum blend_dfactor)
@@ -92,45 +90,52 @@ namespace Renderer {
 
 	void drawRect(int x, int y, int w, int h, unsigned int color, GLenum blend_sfactor, GLenum blend_dfactor)
 	{
-#ifdef USE_OPENGL_ES
-		GLshort points[12];
-#else
-		GLint points[12];
-#endif
+		const float vertices[6 * 4] = {
+			(float)x, (float)y, 0, 0,
+			(float)x, (float)(y + h), 0, 0,
+			(float)(x + w), (float)y, 0, 0,
 
-		points[0] = x; points [1] = y;
-		points[2] = x; points[3] = y + h;
-		points[4] = x + w; points[5] = y;
-
-		points[6] = x + w; points[7] = y;
-		points[8] = x; points[9] = y + h;
-		points[10] = x + w; points[11] = y + h;
+			(float)(x + w), (float)y, 0, 0,
+			(float)x, (float)(y + h), 0, 0,
+			(float)(x + w), (float)(y + h), 0, 0
+		};
 
 		GLubyte colors[6*4];
 		buildGLColorArray(colors, color, 6);
 
-		glEnable(GL_BLEND);
-		glBlendFunc(blend_sfactor, blend_dfactor);
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
+		drawTriangles(0, vertices, colors, 6, blend_sfactor, blend_dfactor);
+	}
 
-#ifdef USE_OPENGL_ES
-		glVertexPointer(2, GL_SHORT, 0, points);
-#else
-		glVertexPointer(2, GL_INT, 0, points);
-#endif
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors);
+	void drawTriangles(unsigned int texture, const float* vertices, const GLubyte* colors, unsigned int count, GLenum blend_sfactor, GLenum blend_dfactor)
+	{
+		getCommandList().drawTriangles(texture, vertices, colors, count, blend_sfactor, blend_dfactor);
+	}
 
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+	void drawLines(const float* points, const GLubyte* colors, unsigned int count)
+	{
+		getCommandList().drawLines(points, colors, count);
+	}
 
-		glDisable(GL_BLEND);
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
+	unsigned int createTexture(GLenum format, GLint minFilter, bool tile, unsigned int width, unsigned int height, const void* data)
+	{
+		const unsigned int texture = nextTexture++;
+		getCommandList().createTexture(texture, format, minFilter, tile ? GL_REPEAT : GL_CLAMP_TO_EDGE, width, height, data);
+		return texture;
+	}
+
+	void updateTexture(unsigned int texture, GLenum format, int x, int y, unsigned int width, unsigned int height, const void* data)
+	{
+		getCommandList().updateTexture(texture, format, x, y, width, height, data);
+	}
+
+	void destroyTexture(unsigned int texture)
+	{
+		getCommandList().destroyTexture(texture);
 	}
 
 	void setMatrix(float* matrix)
 	{
-		glLoadMatrixf(matrix);
+		getCommandList().setMatrix(matrix);
 	}
 
 	void setMatrix(const Eigen::Affine3f& matrix)
@@ -8,11 +8,21 @@
 #include "ImageIO.h"
 #include "../data/Resources.h"
 #include "Settings.h"
+#include "Profiler.h"
+#include "RenderCommandList.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #ifdef USE_OPENGL_ES
 	#define glOrtho glOrthof
 #endif
 
+#define MAX_FRAME_WAIT 32 // longest swapBuffers() waits for the render thread to catch up, in ms
+
 namespace Renderer
 {
 	static bool initialCursorState;
@@ -26,6 +36,36 @@ namespace Renderer
 	SDL_Window* sdlWindow = NULL;
 	SDL_GLContext sdlContext = NULL;
 
+	// Frames are recorded into recordingList on the UI thread and queued in pendingFrames by swapBuffers().
+	// The render thread owns the OpenGL context and draws them; used lists go back to freeLists.
+	static bool threaded = false;
+	static std::thread renderThread;
+	static std::mutex frameMutex;
+	static std::condition_variable frameCondition;
+	static std::deque<RenderCommandList*> pendingFrames;
+	static std::vector<RenderCommandList*> freeLists;
+	static bool stopRendering = false;
+	static RenderCommandList* recordingList = NULL;
+
+	RenderCommandList& getCommandList()
+	{
+		if(recordingList == NULL)
+			recordingList = new RenderCommandList();
+
+		return *recordingList;
+	}
+
+	// must be called with frameMutex locked
+	static RenderCommandList* getFreeList()
+	{
+		if(freeLists.empty())
+			return new RenderCommandList();
+
+		RenderCommandList* list = freeLists.back();
+		freeLists.pop_back();
+		return list;
+	}
+
 	bool createSurface()
 	{
 		LOG(LogInfo) << "Creating surface...";
@@ -116,10 +156,97 @@ namespace Renderer
 		return true;
 	}
 
+	static void setupContext()
+	{
+		glViewport(0, 0, display_width, display_height);
+
+		glMatrixMode(GL_PROJECTION);
+		glOrtho(0, display_width, display_height, 0, -1.0, 1.0);
+		glMatrixMode(GL_MODELVIEW);
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+		// font textures are uploaded one byte per pixel
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		std::string glExts = (const char*)glGetString(GL_EXTENSIONS);
+		LOG(LogInfo) << "Checking available OpenGL extensions...";
+		LOG(LogInfo) << " ARB_texture_non_power_of_two: " << (glExts.find("ARB_texture_non_power_of_two") != std::string::npos ? "ok" : "MISSING");
+	}
+
+	// The render thread owns the context and swaps from there while the main thread pumps the window's events, which
+	// only works where the video driver allows it. Cocoa doesn't, and neither does X11 unless XInitThreads() was called first.
+	static bool canRenderOnThread()
+	{
+		static const char* drivers[] = { "KMSDRM", "RPI", "windows" };
+
+		const char* driver = SDL_GetCurrentVideoDriver();
+		for(unsigned int i = 0; driver != NULL && i < sizeof(drivers) / sizeof(drivers[0]); i++)
+		{
+			if(strcmp(driver, drivers[i]) == 0)
+				return true;
+		}
+
+		return false;
+	}
+
+	static void renderLoop()
+	{
+		SDL_GL_MakeCurrent(sdlWindow, sdlContext);
+		setupContext();
+
+		std::vector<RenderCommandList*> frames;
+		while(true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(frameMutex);
+				frameCondition.wait(lock, [] { return stopRendering || !pendingFrames.empty(); });
+				if(pendingFrames.empty())
+					break;
+
+				frames.assign(pendingFrames.cbegin(), pendingFrames.cend());
+				pendingFrames.clear();
+			}
+			frameCondition.notify_all();
+
+			// if we fell behind only the newest frame is drawn, the older ones just get their texture changes done
+			for(unsigned int i = 0; i < frames.size(); i++)
+				frames[i]->execute(i == frames.size() - 1);
+
+			SDL_GL_SwapWindow(sdlWindow);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			std::unique_lock<std::mutex> lock(frameMutex);
+			for(auto it = frames.cbegin(); it != frames.cend(); it++)
+			{
+				(*it)->clear();
+				freeLists.push_back(*it);
+			}
+		}
+
+		SDL_GL_MakeCurrent(sdlWindow, NULL);
+	}
+
 	void swapBuffers()
 	{
-		SDL_GL_SwapWindow(sdlWindow);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		Profiler::Scope scope("Renderer::swapBuffers", "gl");
+
+		if(!threaded)
+		{
+			getCommandList().execute(true);
+			getCommandList().clear();
+			SDL_GL_SwapWindow(sdlWindow);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(frameMutex);
+		pendingFrames.push_back(&getCommandList());
+		recordingList = getFreeList();
+		frameCondition.notify_all();
+
+		// don't get more than a frame ahead of the render thread, but don't hold up input for long either
+		frameCondition.wait_for(lock, std::chrono::milliseconds(MAX_FRAME_WAIT), [] { return pendingFrames.empty(); });
 	}
 
 	void destroySurface()
@@ -148,18 +275,45 @@ namespace Renderer
 		if(!createdSurface)
 			return false;
 
-		glViewport(0, 0, display_width, display_height);
+		threaded = Settings::getInstance()->getBool("ThreadedRendering") && canRenderOnThread();
+		if(Settings::getInstance()->getBool("ThreadedRendering") && !threaded)
+		{
+			const char* driver = SDL_GetCurrentVideoDriver();
+			LOG(LogInfo) << "Rendering on the main thread, the \"" << (driver ? driver : "") << "\" video driver doesn't support threaded rendering";
+		}
 
-		glMatrixMode(GL_PROJECTION);
-		glOrtho(0, display_width, display_height, 0, -1.0, 1.0);
-		glMatrixMode(GL_MODELVIEW);
-		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		if(threaded)
+		{
+			// the context is handed over to the render thread, which sets it up
+			SDL_GL_MakeCurrent(sdlWindow, NULL);
+			stopRendering = false;
+			renderThread = std::thread(renderLoop);
+		}else{
+			setupContext();
+		}
 
 		return true;
 	}
 
 	void deinit()
 	{
+		if(threaded)
+		{
+			{
+				std::unique_lock<std::mutex> lock(frameMutex);
+				stopRendering = true;
+			}
+			frameCondition.notify_all();
+			renderThread.join();
+
+			SDL_GL_MakeCurrent(sdlWindow, sdlContext);
+		}
+
+		// textures deleted since the last frame still need deleting, but a half recorded frame shouldn't be drawn
+		getCommandList().execute(false);
+		getCommandList().clear();
+		RenderCommandList::resetTextures();
+
 		destroySurface();
 	}
 };
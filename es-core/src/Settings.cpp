@@ -15,11 +15,20 @@ std::vector<const char*> settings_dont_save {
 	{ "ParseGamelistOnly" },
 	{ "Windowed" },
 	{ "VSync" },
+	{ "MaxFPS" },
 	{ "HideConsole" },
 	{ "IgnoreGamelist" },
 	{ "ForceHandheld" },
 	{ "ForceKiosk" },
-	{ "SplashScreen" }
+	{ "SplashScreen" },
+	{ "BootReport" },
+	{ "ScraperUrl" },
+	{ "Scrape" },
+	{ "ScrapeSystems" },
+	{ "ScrapeFilter" },
+	{ "ScrapeScraper" },
+	{ "ScrapeMaxSearches" },
+	{ "ScrapeMaxDownloads" }
 };
 
 Settings::Settings()
@@ -49,6 +58,7 @@ void Settings::setDefaults()
 	mBoolMap["ForceKiosk"] = false;
 
 	mBoolMap["VSync"] = true;
+	mBoolMap["ThreadedRendering"] = true; // only with the video drivers Renderer_init_sdlgl.cpp knows to support it
 
 	mBoolMap["EnableSounds"] = true;
 	mBoolMap["ShowHelpPrompts"] = true;
@@ -61,16 +71,34 @@ void Settings::setDefaults()
 	mBoolMap["Debug"] = false;
 	mBoolMap["DebugGrid"] = false;
 	mBoolMap["DebugText"] = false;
+	mBoolMap["BootReport"] = false;
+	mBoolMap["Scrape"] = false; // --scrape, see BatchScrape.h
 
 	mIntMap["ScreenSaverTime"] = 5*60*1000; // 5 minutes
 	mIntMap["ScraperResizeWidth"] = 400;
 	mIntMap["ScraperResizeHeight"] = 0;
+	mIntMap["MaxFPS"] = 0; // 0 leaves the frame rate to vsync
+	mIntMap["MaxGameListViews"] = 8; // 0 keeps every gamelist view once it's built
 	mBoolMap["ScraperSaveImageToGamelist"] = false;
+	mIntMap["ScraperMaxSearches"] = 4; // searches in flight at once when scraping without approval
+	mIntMap["ScraperMaxDownloads"] = 4;
+	mIntMap["ScraperRequestsPerSecond"] = 2; // per host, 0 for no limit
+	mIntMap["ScrapeMaxSearches"] = 0; // --scrape-searches, ScraperMaxSearches if 0
+	mIntMap["ScrapeMaxDownloads"] = 0; // --scrape-downloads, ScraperMaxDownloads if 0
+	mIntMap["RomHashThreads"] = 0; // ROMs checksummed at once for scrapers that look games up by hash, 0 for one per core
+	mIntMap["HttpCacheSize"] = 256; // MB of responses kept in ~/.emulationstation/http_cache, 0 turns the cache off
+	mIntMap["HttpCacheTTL"] = 7*24*60*60; // seconds a response is used without asking the server, unless it says otherwise
+	mBoolMap["Http2"] = true; // HTTP/2 where the server supports it, which lets requests to the same server share one connection
 
 	mStringMap["TransitionStyle"] = "fade";
 	mStringMap["ThemeSet"] = "";
 	mStringMap["ScreenSaverBehavior"] = "dim";
 	mStringMap["Scraper"] = "TheGamesDB";
+	mStringMap["ScraperUrl"] = ""; // replaces the scraper's API address, e.g. to test against a local server
+	mStringMap["ScrapeSystems"] = "";
+	mStringMap["ScrapeFilter"] = "missing";
+	mStringMap["ScrapeScraper"] = ""; // --scraper, Scraper if empty
+	mStringMap["LocalScraperPath"] = ""; // where the "Local" scraper's gamelists are, ~/.emulationstation/scrapers/local if empty
 
 	// Audio out device for volume control
 	#ifdef _RPI_
@@ -6,6 +6,9 @@
 #include "Log.h"
 #include "Settings.h"
 #include <pugixml.hpp>
+#include <mutex>
+#include <unordered_map>
+#include <assert.h>
 
 #include "components/ImageComponent.h"
 #include "components/TextComponent.h"
@@ -176,9 +179,48 @@ std::string resolvePath(const char* in, const fs::path& relative)
 	return path.generic_string();
 }
 
-std::map<std::string, std::string> mVariables;
+// Included files are usually shared by every system in a theme set (e.g. a common.xml), so each one is only
+// read and parsed once. Variables are resolved afterwards, per ThemeData, so the parsed documents can be shared.
+// Keyed by canonical path, an entry is parsed again if the file's modification time changed.
+struct CachedInclude
+{
+	std::time_t modified;
+	std::shared_ptr<pugi::xml_document> doc;
+};
+
+static std::map<std::string, CachedInclude> sIncludeCache;
+static std::mutex sIncludeCacheMutex;
 
-std::string resolvePlaceholders(const char* in)
+static std::shared_ptr<pugi::xml_document> loadInclude(const std::string& path, std::string* parseError)
+{
+	boost::system::error_code ec;
+	fs::path canonicalPath = fs::canonical(path, ec);
+	const std::string key = ec ? path : canonicalPath.generic_string();
+	const std::time_t modified = fs::last_write_time(path, ec);
+
+	{
+		std::unique_lock<std::mutex> lock(sIncludeCacheMutex);
+		auto it = sIncludeCache.find(key);
+		if(it != sIncludeCache.cend() && it->second.modified == modified)
+			return it->second.doc;
+	}
+
+	// parse without holding the lock, documents are only ever read once they're in the cache
+	std::shared_ptr<pugi::xml_document> doc = std::make_shared<pugi::xml_document>();
+	pugi::xml_parse_result result = doc->load_file(path.c_str());
+	if(!result)
+	{
+		*parseError = result.description();
+		return nullptr;
+	}
+
+	CachedInclude cached = { modified, doc };
+	std::unique_lock<std::mutex> lock(sIncludeCacheMutex);
+	sIncludeCache[key] = cached;
+	return doc;
+}
+
+std::string ThemeData::resolvePlaceholders(const char* in)
 {
 	std::string inStr(in);
 
@@ -198,6 +240,86 @@ std::string resolvePlaceholders(const char* in)
 	return prefix + mVariables[replace] + suffix;
 }
 
+const ThemeData::PropertyInfo* ThemeData::getPropertyInfo(const std::string& name)
+{
+	static const std::unordered_map<std::string, PropertyInfo> properties = [] {
+		std::unordered_map<std::string, PropertyInfo> map;
+		for(auto elemIt = sElementMap.cbegin(); elemIt != sElementMap.cend(); elemIt++)
+		{
+			for(auto propIt = elemIt->second.cbegin(); propIt != elemIt->second.cend(); propIt++)
+			{
+				auto existing = map.find(propIt->first);
+				if(existing != map.cend())
+				{
+					// a name has to mean the same type everywhere, since the id decides where its value is stored
+					assert(existing->second.type == propIt->second);
+					continue;
+				}
+
+				// there's a bit per id in ThemeElement's masks, themes using this one fail to load instead
+				if(map.size() == MAX_PROPERTIES)
+				{
+					LOG(LogError) << "More than " << MAX_PROPERTIES << " theme properties, \"" << propIt->first << "\" can't be used";
+					continue;
+				}
+
+				PropertyInfo info = { (unsigned int)map.size(), propIt->second, propIt->first };
+				map[propIt->first] = info;
+			}
+		}
+
+		return map;
+	}();
+
+	auto it = properties.find(name);
+	return it != properties.cend() ? &it->second : NULL;
+}
+
+unsigned int ThemeData::ThemeElement::getSlot(const PropertyInfo* prop, ElementPropertyType type, ElementPropertyType altType) const
+{
+	if(!prop)
+		throw std::out_of_range("Theme element property does not exist");
+
+	if(!(mPresent & (1ull << prop->id)))
+		throw std::out_of_range("Theme element property \"" + prop->name + "\" is not set");
+
+	if(prop->type != type && prop->type != altType)
+		throw std::invalid_argument("Theme element property \"" + prop->name + "\" requested as the wrong type");
+
+	return mSlots[prop->id];
+}
+
+template<typename T>
+void ThemeData::ThemeElement::setValue(std::vector<T>& values, unsigned int id, const T& value)
+{
+	// elements can be defined more than once (e.g. by an include and then the system's theme), later values replace earlier ones
+	if(mPresent & (1ull << id))
+	{
+		values[mSlots[id]] = value;
+		return;
+	}
+
+	mSlots[id] = (unsigned char)values.size();
+	values.push_back(value);
+	mPresent |= (1ull << id);
+}
+
+void ThemeData::ThemeElement::set(const PropertyInfo& info, const Eigen::Vector2f& value) { setValue(mPairs, info.id, value); }
+void ThemeData::ThemeElement::set(const PropertyInfo& info, const std::string& value) { setValue(mStrings, info.id, value); }
+void ThemeData::ThemeElement::set(const PropertyInfo& info, unsigned int value) { setValue(mColors, info.id, value); }
+void ThemeData::ThemeElement::set(const PropertyInfo& info, float value) { setValue(mFloats, info.id, value); }
+
+void ThemeData::ThemeElement::set(const PropertyInfo& info, bool value)
+{
+	mSlots[info.id] = (unsigned char)info.id;
+	mPresent |= (1ull << info.id);
+
+	if(value)
+		mBools |= (1ull << info.id);
+	else
+		mBools &= ~(1ull << info.id);
+}
+
 ThemeData::ThemeData()
 {
 	mVersion = 0;
@@ -258,12 +380,12 @@ void ThemeData::parseIncludes(const pugi::xml_node& root)
 
 		mPaths.push_back(path);
 
-		pugi::xml_document includeDoc;
-		pugi::xml_parse_result result = includeDoc.load_file(path.c_str());
-		if(!result)
-			throw error << "Error parsing file: \n    " << result.description();
+		std::string parseError;
+		std::shared_ptr<pugi::xml_document> includeDoc = loadInclude(path, &parseError);
+		if(!includeDoc)
+			throw error << "Error parsing file: \n    " << parseError;
 
-		pugi::xml_node theme = includeDoc.child("theme");
+		pugi::xml_node theme = includeDoc->child("theme");
 		if(!theme)
 			throw error << "Missing <theme> tag!";
 
@@ -394,6 +516,11 @@ void ThemeData::parseElement(const pugi::xml_node& root, const std::map<std::str
 		if(typeIt == typeMap.cend())
 			throw error << "Unknown property type \"" << node.name() << "\" (for element of type " << root.name() << ").";
 
+		const PropertyInfo* found = getPropertyInfo(node.name());
+		if(!found)
+			throw error << "Property \"" << node.name() << "\" is not supported, there are too many properties (for element of type " << root.name() << ").";
+
+		const PropertyInfo& info = *found;
 		std::string str = resolvePlaceholders(node.text().as_string());
 
 		switch(typeIt->second)
@@ -409,11 +536,11 @@ void ThemeData::parseElement(const pugi::xml_node& root, const std::map<std::str
 
 			Eigen::Vector2f val(atof(first.c_str()), atof(second.c_str()));
 
-			element.properties[node.name()] = val;
+			element.set(info, val);
 			break;
 		}
 		case STRING:
-			element.properties[node.name()] = str;
+			element.set(info, str);
 			break;
 		case PATH:
 		{
@@ -427,16 +554,16 @@ void ThemeData::parseElement(const pugi::xml_node& root, const std::map<std::str
 					ss << "(which resolved to \"" << path << "\") ";
 				LOG(LogWarning) << ss.str();
 			}
-			element.properties[node.name()] = path;
+			element.set(info, path);
 			break;
 		}
 		case COLOR:
-			element.properties[node.name()] = getHexColor(str.c_str());
+			element.set(info, getHexColor(str.c_str()));
 			break;
 		case FLOAT:
 		{
 			float floatVal = static_cast<float>(strtod(str.c_str(), 0));
-			element.properties[node.name()] = floatVal;
+			element.set(info, floatVal);
 			break;
 		}
 
@@ -447,7 +574,7 @@ void ThemeData::parseElement(const pugi::xml_node& root, const std::map<std::str
 			// 1*, t* (true), T* (True), y* (yes), Y* (YES)
 			bool boolVal = (first == '1' || first == 't' || first == 'T' || first == 'y' || first == 'Y');
 
-			element.properties[node.name()] = boolVal;
+			element.set(info, boolVal);
 			break;
 		}
 		default:
@@ -567,6 +694,15 @@ std::map<std::string, ThemeSet> ThemeData::getThemeSets()
 }
 
 fs::path ThemeData::getThemeFromCurrentSet(const std::string& system)
+{
+	const fs::path path = getCurrentThemeSetPath();
+	if(path.empty())
+		return "";
+
+	return ThemeSet{path}.getThemePath(system);
+}
+
+fs::path ThemeData::getCurrentThemeSetPath()
 {
 	auto themeSets = ThemeData::getThemeSets();
 	if(themeSets.empty())
@@ -583,5 +719,5 @@ fs::path ThemeData::getThemeFromCurrentSet(const std::string& system)
 		Settings::getInstance()->setString("ThemeSet", set->first);
 	}
 
-	return set->second.getThemePath(system);
+	return set->second.path;
 }
@@ -8,8 +8,8 @@
 #include <map>
 #include <deque>
 #include <string>
+#include <stdexcept>
 #include <boost/filesystem.hpp>
-#include <boost/variant.hpp>
 #include <Eigen/Dense>
 #include <pugixml.hpp>
 #include "GuiComponent.h"
@@ -85,18 +85,72 @@ class ThemeData
 {
 public:
 
+	enum ElementPropertyType
+	{
+		NORMALIZED_PAIR,
+		PATH,
+		STRING,
+		COLOR,
+		FLOAT,
+		BOOLEAN
+	};
+
+	// Every property name in sElementMap is given a small id when first used, so an element can store its
+	// properties in typed arrays with a presence bitmask instead of a map of variants.
+	// Code that reads the same properties from many elements (applyTheme) can look them up once with getPropertyInfo()
+	// and pass those in, saving a hash of the name per call.
+	struct PropertyInfo
+	{
+		unsigned int id;
+		ElementPropertyType type;
+		std::string name;
+	};
+
+	static const unsigned int MAX_PROPERTIES = 64; // one bit per property in ThemeElement's masks, any past that are left without an id
+
 	class ThemeElement
 	{
 	public:
+		ThemeElement() : extra(false), mPresent(0), mBools(0) {}
+
 		bool extra;
 		std::string type;
 
-		std::map< std::string, boost::variant<Eigen::Vector2f, std::string, unsigned int, float, bool> > properties;
+		// throws std::out_of_range if the property isn't set and std::invalid_argument if T doesn't match its type
+		template<typename T>
+		T get(const PropertyInfo* prop) const;
 
 		template<typename T>
-		T get(const std::string& prop) const { return boost::get<T>(properties.at(prop)); }
+		inline T get(const std::string& prop) const
+		{
+			const PropertyInfo* info = getPropertyInfo(prop);
+			if(!info)
+				throw std::out_of_range("Theme element property \"" + prop + "\" does not exist");
+			return get<T>(info);
+		}
+
+		inline bool has(const PropertyInfo* prop) const { return prop && (mPresent & (1ull << prop->id)); }
+		inline bool has(const std::string& prop) const { return has(getPropertyInfo(prop)); }
+
+		void set(const PropertyInfo& info, const Eigen::Vector2f& value);
+		void set(const PropertyInfo& info, const std::string& value);
+		void set(const PropertyInfo& info, unsigned int value);
+		void set(const PropertyInfo& info, float value);
+		void set(const PropertyInfo& info, bool value);
+
+	private:
+		unsigned int getSlot(const PropertyInfo* prop, ElementPropertyType type, ElementPropertyType altType) const;
+		template<typename T>
+		void setValue(std::vector<T>& values, unsigned int id, const T& value);
 
-		inline bool has(const std::string& prop) const { return (properties.find(prop) != properties.cend()); }
+		unsigned long long mPresent; // bit per property id
+		unsigned long long mBools; // values of BOOLEAN properties, bit per property id
+		unsigned char mSlots[MAX_PROPERTIES]; // index into the array for the property's type (the bit in mBools for BOOLEAN), valid if present
+
+		std::vector<Eigen::Vector2f> mPairs;
+		std::vector<std::string> mStrings; // PATH and STRING
+		std::vector<unsigned int> mColors;
+		std::vector<float> mFloats;
 	};
 
 private:
@@ -114,15 +168,7 @@ public:
 	// throws ThemeException
 	void loadFile(std::map<std::string, std::string> sysDataMap, const std::string& path);
 
-	enum ElementPropertyType
-	{
-		NORMALIZED_PAIR,
-		PATH,
-		STRING,
-		COLOR,
-		FLOAT,
-		BOOLEAN
-	};
+	static const PropertyInfo* getPropertyInfo(const std::string& name); // NULL if no element type has this property
 
 	bool hasView(const std::string& view);
 
@@ -135,6 +181,8 @@ public:
 
 	static std::map<std::string, ThemeSet> getThemeSets();
 	static boost::filesystem::path getThemeFromCurrentSet(const std::string& system);
+	// Settings "ThemeSet", which is changed to the first set there is if it's gone, so main thread only. Empty with no sets.
+	static boost::filesystem::path getCurrentThemeSetPath();
 
 private:
 	static std::map< std::string, std::map<std::string, ElementPropertyType> > sElementMap;
@@ -143,6 +191,7 @@ private:
 
 	std::deque<boost::filesystem::path> mPaths;
 	float mVersion;
+	std::map<std::string, std::string> mVariables; // system.name etc. and the theme's <variables>, used by resolvePlaceholders()
 
 	void parseFeatures(const pugi::xml_node& themeRoot);
 	void parseIncludes(const pugi::xml_node& themeRoot);
@@ -150,8 +199,27 @@ private:
 	void parseViews(const pugi::xml_node& themeRoot);
 	void parseView(const pugi::xml_node& viewNode, ThemeView& view);
 	void parseElement(const pugi::xml_node& elementNode, const std::map<std::string, ElementPropertyType>& typeMap, ThemeElement& element);
+	std::string resolvePlaceholders(const char* in);
 
 	std::map<std::string, ThemeView> mViews;
 };
 
+template<>
+inline Eigen::Vector2f ThemeData::ThemeElement::get<Eigen::Vector2f>(const PropertyInfo* prop) const { return mPairs[getSlot(prop, NORMALIZED_PAIR, NORMALIZED_PAIR)]; }
+
+template<>
+inline std::string ThemeData::ThemeElement::get<std::string>(const PropertyInfo* prop) const { return mStrings[getSlot(prop, STRING, PATH)]; }
+
+template<>
+inline unsigned int ThemeData::ThemeElement::get<unsigned int>(const PropertyInfo* prop) const { return mColors[getSlot(prop, COLOR, COLOR)]; }
+
+template<>
+inline float ThemeData::ThemeElement::get<float>(const PropertyInfo* prop) const { return mFloats[getSlot(prop, FLOAT, FLOAT)]; }
+
+template<>
+inline bool ThemeData::ThemeElement::get<bool>(const PropertyInfo* prop) const
+{
+	return (mBools & (1ull << getSlot(prop, BOOLEAN, BOOLEAN))) != 0;
+}
+
 #endif // ES_CORE_THEME_DATA_H
@@ -4,13 +4,21 @@
 #include "AudioManager.h"
 #include "Log.h"
 #include "Settings.h"
+#include "Profiler.h"
 #include <algorithm>
 #include <iomanip>
+#include <sstream>
 #include "components/HelpComponent.h"
 #include "components/ImageComponent.h"
 
+#define MAX_IDLE_TIME 1000 // longest the main loop waits for input without updating, deltaTime is capped to this as well
+#define UPDATE_STEP 4 // ms of time components are updated with at once
+#define MAX_UPDATE_STEPS 25 // most steps done in one frame
+#define TARGET_FRAME_TIME 16 // ms a frame may take at 60fps before it counts as dropped, unless --max-fps says otherwise
+
 Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCountElapsed(0), mAverageDeltaTime(10),
-	mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0)
+	mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mDirty(true), mTimeUntilUpdate(0),
+	mUpdateAccumulator(0), mFrameDrawn(false), mFrameCount(0), mDroppedFrames(0)
 {
 	mHelp = new HelpComponent(this);
 	mBackgroundOverlay = new ImageComponent(this);
@@ -31,6 +39,7 @@ void Window::pushGui(GuiComponent* gui)
 {
 	mGuiStack.push_back(gui);
 	gui->updateHelpPrompts();
+	invalidate();
 }
 
 void Window::removeGui(GuiComponent* gui)
@@ -40,6 +49,7 @@ void Window::removeGui(GuiComponent* gui)
 		if(*i == gui)
 		{
 			i = mGuiStack.erase(i);
+			invalidate();
 
 			if(i == mGuiStack.cend() && mGuiStack.size()) // we just popped the stack and the stack is not empty
 				mGuiStack.back()->updateHelpPrompts();
@@ -85,6 +95,8 @@ bool Window::init(unsigned int width, unsigned int height)
 	if(peekGui())
 		peekGui()->updateHelpPrompts();
 
+	invalidate();
+
 	return true;
 }
 
@@ -97,12 +109,16 @@ void Window::deinit()
 
 void Window::textInput(const char* text)
 {
+	invalidate();
+
 	if(peekGui())
 		peekGui()->textInput(text);
 }
 
 void Window::input(InputConfig* config, Input input)
 {
+	invalidate();
+
 	if(mSleeping)
 	{
 		// wake up
@@ -124,6 +140,17 @@ void Window::input(InputConfig* config, Input input)
 		// toggle TextComponent debug view with Ctrl-T
 		Settings::getInstance()->setBool("DebugText", !Settings::getInstance()->getBool("DebugText"));
 	}
+	else if(config->getDeviceId() == DEVICE_KEYBOARD && input.value && input.id == SDLK_p && SDL_GetModState() & KMOD_LCTRL && Settings::getInstance()->getBool("Debug"))
+	{
+		// toggle frame-time profiler with Ctrl-P
+		Profiler::setEnabled(!Profiler::isEnabled());
+		mFrameDataText.reset();
+	}
+	else if(config->getDeviceId() == DEVICE_KEYBOARD && input.value && input.id == SDLK_d && SDL_GetModState() & KMOD_LCTRL && Profiler::isEnabled())
+	{
+		// dump the recorded frames as a Chrome trace with Ctrl-D
+		Profiler::writeTrace(Profiler::getTracePath());
+	}
 	else
 	{
 		if(peekGui())
@@ -133,6 +160,9 @@ void Window::input(InputConfig* config, Input input)
 
 void Window::update(int deltaTime)
 {
+	Profiler::frameStart();
+	Profiler::Scope scope("Window::update", "update");
+
 	if(mNormalizeNextUpdate)
 	{
 		mNormalizeNextUpdate = false;
@@ -140,6 +170,14 @@ void Window::update(int deltaTime)
 			deltaTime = mAverageDeltaTime;
 	}
 
+	// a frame that took much longer than it should have while things were moving (the loop only waits after frames that drew nothing)
+	const int maxFPS = Settings::getInstance()->getInt("MaxFPS");
+	const int frameTime = (maxFPS > 0 ? 1000 / maxFPS : TARGET_FRAME_TIME);
+	if(mFrameDrawn && deltaTime >= frameTime * 3 / 2)
+		mDroppedFrames += (deltaTime + frameTime / 2) / frameTime - 1;
+	mFrameDrawn = false;
+	mFrameCount++;
+
 	mFrameTimeElapsed += deltaTime;
 	mFrameCountElapsed++;
 	if(mFrameTimeElapsed > 500)
@@ -147,10 +185,55 @@ void Window::update(int deltaTime)
 		mAverageDeltaTime = mFrameTimeElapsed / mFrameCountElapsed;
 		mFrameTimeElapsed = 0;
 		mFrameCountElapsed = 0;
+
+		if(Profiler::isEnabled())
+			updateProfilerText();
+	}
+	// components are always updated in steps of the same length, so animations play out the same at any frame rate;
+	// the time that doesn't make up a whole step is carried over to the next frame
+	mUpdateAccumulator += deltaTime;
+	int steps = mUpdateAccumulator / UPDATE_STEP;
+	mUpdateAccumulator -= steps * UPDATE_STEP;
+
+	// after an idle wait or a long stall more is owed than is worth stepping through, the rest goes into one update like it used to
+	int extraTime = 0;
+	if(steps > MAX_UPDATE_STEPS)
+	{
+		extraTime = (steps - MAX_UPDATE_STEPS) * UPDATE_STEP;
+		steps = MAX_UPDATE_STEPS;
 	}
+
+	// what components asked for last time still stands if they aren't updated this time
+	if(steps > 0)
+		mTimeUntilUpdate = MAX_IDLE_TIME;
+	else
+		mTimeUntilUpdate = std::max(0, std::min(mTimeUntilUpdate - deltaTime, UPDATE_STEP - mUpdateAccumulator));
+
+	// the screensaver has to be drawn once it kicks in, and anything busy in the background (downloads) may change the screen
+	unsigned int screensaverTime = (unsigned int)Settings::getInstance()->getInt("ScreenSaverTime");
+	if(screensaverTime != 0 && mTimeSinceLastInput < screensaverTime)
+	{
+		if(mTimeSinceLastInput + deltaTime >= screensaverTime)
+			invalidate();
+		else
+			scheduleUpdate(screensaverTime - (mTimeSinceLastInput + deltaTime));
+	}
+	if(isProcessing() || Profiler::isEnabled())
+		invalidate();
+
 	mTimeSinceLastInput += deltaTime;
-	if(peekGui())
-		peekGui()->update(deltaTime);
+
+	if(extraTime && peekGui())
+	{
+		Profiler::Scope guiScope(peekGui(), "update");
+		peekGui()->update(extraTime);
+	}
+
+	for(int i = 0; i < steps && peekGui(); i++)
+	{
+		Profiler::Scope guiScope(peekGui(), "update");
+		peekGui()->update(UPDATE_STEP);
+	}
 }
 
 void Window::render()
@@ -158,17 +241,25 @@ void Window::render()
 	Eigen::Affine3f transform = Eigen::Affine3f::Identity();
 
 	mRenderedHelpPrompts = false;
+	mFrameDrawn = true;
 
 	// draw only bottom and top of GuiStack (if they are different)
 	if(mGuiStack.size())
 	{
+		Profiler::Scope scope("Window::render", "render");
+
 		auto& bottom = mGuiStack.front();
 		auto& top = mGuiStack.back();
 
-		bottom->render(transform);
+		{
+			Profiler::Scope bottomScope(bottom, "render");
+			bottom->render(transform);
+		}
 		if(bottom != top)
 		{
 			mBackgroundOverlay->render(transform);
+
+			Profiler::Scope topScope(top, "render");
 			top->render(transform);
 		}
 	}
@@ -188,6 +279,19 @@ void Window::render()
 			onSleep();
 		}
 	}
+
+	if(Profiler::isEnabled())
+		renderProfiler();
+
+	// properties views set on their children while drawing (carousel logos, the list selector) are already in
+	// this frame, and a logo drawn twice with different values must not keep the window dirty forever
+	mDirty = false;
+}
+
+void Window::scheduleUpdate(int ms)
+{
+	if(ms < mTimeUntilUpdate)
+		mTimeUntilUpdate = ms < 0 ? 0 : ms;
 }
 
 void Window::normalizeNextUpdate()
@@ -205,7 +309,7 @@ void Window::setAllowSleep(bool sleep)
 	mAllowSleep = sleep;
 }
 
-void Window::renderLoadingScreen()
+void Window::renderLoadingScreen(const std::string& text, float percent)
 {
 	Eigen::Affine3f trans = Eigen::Affine3f::Identity();
 	Renderer::setMatrix(trans);
@@ -218,11 +322,24 @@ void Window::renderLoadingScreen()
 	splash.render(trans);
 
 	auto& font = mDefaultFonts.at(1);
-	TextCache* cache = font->buildTextCache("LOADING...", 0, 0, 0x656565FF);
+	TextCache* cache = font->buildTextCache(text, 0, 0, 0x656565FF);
 	trans = trans.translate(Eigen::Vector3f(round((Renderer::getScreenWidth() - cache->metrics.size.x()) / 2.0f),
 		round(Renderer::getScreenHeight() * 0.835f), 0.0f));
 	Renderer::setMatrix(trans);
 	font->renderTextCache(cache);
+
+	if(percent >= 0)
+	{
+		const float barWidth = Renderer::getScreenWidth() * 0.4f;
+		const float barHeight = round(Renderer::getScreenHeight() * 0.008f);
+		const float barY = round(Renderer::getScreenHeight() * 0.835f + cache->metrics.size.y() * 1.5f);
+
+		trans = Eigen::Affine3f::Identity();
+		Renderer::setMatrix(trans);
+		Renderer::drawRect((Renderer::getScreenWidth() - barWidth) / 2, barY, barWidth, barHeight, 0x222222FF);
+		Renderer::drawRect((Renderer::getScreenWidth() - barWidth) / 2, barY, barWidth * std::min(percent, 1.0f), barHeight, 0x656565FF);
+	}
+
 	delete cache;
 
 	Renderer::swapBuffers();
@@ -236,6 +353,7 @@ void Window::renderHelpPromptsEarly()
 
 void Window::setHelpPrompts(const std::vector<HelpPrompt>& prompts, const HelpStyle& style)
 {
+	invalidate();
 	mHelp->clearPrompts();
 	mHelp->setStyle(style);
 
@@ -304,6 +422,61 @@ void Window::setHelpPrompts(const std::vector<HelpPrompt>& prompts, const HelpSt
 }
 
 
+void Window::updateProfilerText()
+{
+	const std::vector<float> frameTimes = Profiler::getFrameTimes();
+	if(frameTimes.empty())
+		return;
+
+	float total = 0.0f;
+	float highest = 0.0f;
+	for(auto it = frameTimes.cbegin(); it != frameTimes.cend(); it++)
+	{
+		total += *it;
+		if(*it > highest)
+			highest = *it;
+	}
+
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(2);
+	ss << "FRAME " << (total / frameTimes.size()) << " ms avg, " << highest << " ms max, " << mDroppedFrames << " dropped (Ctrl-D to save trace)\n";
+
+	const std::vector<Profiler::Offender> offenders = Profiler::getTopOffenders(8);
+	for(auto it = offenders.cbegin(); it != offenders.cend(); it++)
+		ss << std::setw(6) << it->selfTime << " ms  " << it->category << "  " << it->name << "\n";
+
+	mFrameDataText = std::unique_ptr<TextCache>(mDefaultFonts.at(0)->buildTextCache(ss.str(), 0.0f, 0.0f, 0xFF00FFFF));
+}
+
+void Window::renderProfiler()
+{
+	const float screenWidth = (float)Renderer::getScreenWidth();
+	const float screenHeight = (float)Renderer::getScreenHeight();
+
+	Renderer::setMatrix(Eigen::Affine3f::Identity());
+
+	// frame time graph along the bottom of the screen, the line marks 60fps
+	const std::vector<float> frameTimes = Profiler::getFrameTimes();
+	const float graphHeight = screenHeight * 0.15f;
+	const float barWidth = screenWidth / Profiler::MAX_FRAMES;
+	const float msHeight = graphHeight / 50.0f;
+
+	Renderer::drawRect(0.0f, screenHeight - graphHeight, screenWidth, graphHeight, 0x00000080);
+	for(unsigned int i = 0; i < frameTimes.size(); i++)
+	{
+		const float ms = std::min(frameTimes.at(i), 50.0f);
+		const unsigned int color = (ms <= 17.0f ? 0x00FF00C0 : (ms <= 34.0f ? 0xFFFF00C0 : 0xFF0000C0));
+		Renderer::drawRect(i * barWidth, screenHeight - ms * msHeight, barWidth, ms * msHeight, color);
+	}
+	Renderer::drawRect(0.0f, screenHeight - 16.7f * msHeight, screenWidth, 1.0f, 0xFFFFFFFF);
+
+	if(mFrameDataText)
+	{
+		Renderer::drawRect(0.0f, 0.0f, mFrameDataText->metrics.size.x(), mFrameDataText->metrics.size.y(), 0x00000080);
+		mDefaultFonts.at(0)->renderTextCache(mFrameDataText.get());
+	}
+}
+
 void Window::onSleep()
 {
 }
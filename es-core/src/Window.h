@@ -30,11 +30,26 @@ public:
 
 	void normalizeNextUpdate();
 
+	// Frames are only drawn when something changed since the last one, see GuiComponent::invalidate().
+	inline void invalidate() { mDirty = true; }
+	inline bool isDirty() const { return mDirty; }
+
+	// When nothing is drawn the main loop waits for input, at most until the soonest time asked for here.
+	// Timers that don't invalidate every frame (key repeat, marquee steps) must ask for their next tick in update().
+	void scheduleUpdate(int ms);
+	inline int getTimeUntilUpdate() const { return mTimeUntilUpdate; }
+
+	// Counts update() calls, so components that are updated several times a frame can tell whether it's still the same one.
+	inline unsigned int getFrameCount() const { return mFrameCount; }
+
+	// Frames that took 1.5 frame times or more while something was moving, counted as the number of frames missed.
+	inline unsigned int getDroppedFrames() const { return mDroppedFrames; }
+
 	inline bool isSleeping() const { return mSleeping; }
 	bool getAllowSleep();
 	void setAllowSleep(bool sleep);
 	
-	void renderLoadingScreen();
+	void renderLoadingScreen(const std::string& text = "LOADING...", float percent = -1); // draws a progress bar under the text if percent >= 0
 
 	void renderHelpPromptsEarly(); // used to render HelpPrompts before a fade
 	void setHelpPrompts(const std::vector<HelpPrompt>& prompts, const HelpStyle& style);
@@ -47,6 +62,9 @@ private:
 	bool isProcessing();
 	void renderScreenSaver();
 
+	void updateProfilerText();
+	void renderProfiler();
+
 	HelpComponent* mHelp;
 	ImageComponent* mBackgroundOverlay;
 
@@ -67,6 +85,12 @@ private:
 	unsigned int mTimeSinceLastInput;
 
 	bool mRenderedHelpPrompts;
+	bool mDirty;
+	int mTimeUntilUpdate;
+	int mUpdateAccumulator; // ms not yet passed on to components, less than one update step
+	bool mFrameDrawn; // render() was called since the last update()
+	unsigned int mFrameCount;
+	unsigned int mDroppedFrames;
 };
 
 #endif // ES_CORE_WINDOW_H
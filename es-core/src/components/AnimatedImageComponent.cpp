@@ -1,5 +1,6 @@
 #include "components/AnimatedImageComponent.h"
 #include "Log.h"
+#include "Window.h"
 
 AnimatedImageComponent::AnimatedImageComponent(Window* window) : GuiComponent(window), mEnabled(false)
 {
@@ -57,6 +58,7 @@ void AnimatedImageComponent::update(int deltaTime)
 	while(mFrames.at(mCurrentFrame).second <= mFrameAccumulator)
 	{
 		mCurrentFrame++;
+		invalidate();
 
 		if(mCurrentFrame == mFrames.size())
 		{
@@ -74,6 +76,9 @@ void AnimatedImageComponent::update(int deltaTime)
 
 		mFrameAccumulator -= mFrames.at(mCurrentFrame).second;
 	}
+
+	if(mEnabled)
+		mWindow->scheduleUpdate(mFrames.at(mCurrentFrame).second - mFrameAccumulator);
 }
 
 void AnimatedImageComponent::render(const Eigen::Affine3f& trans)
@@ -194,7 +194,7 @@ void ComponentGrid::updateSeparators()
 		}
 	}
 
-	mLineColors.reserve(mLines.size());
+	mLineColors.resize(mLines.size());
 	Renderer::buildGLColorArray((GLubyte*)mLineColors.data(), 0xC6C7C6FF, mLines.size());
 }
 
@@ -365,20 +365,7 @@ void ComponentGrid::render(const Eigen::Affine3f& parentTrans)
 	if(mLines.size())
 	{
 		Renderer::setMatrix(trans);
-
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(2, GL_FLOAT, 0, &mLines[0].x);
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, mLineColors.data());
-
-		glDrawArrays(GL_LINES, 0, (GLsizei)mLines.size());
-
-		glDisable(GL_BLEND);
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
+		Renderer::drawLines(&mLines[0].x, (const GLubyte*)mLineColors.data(), (unsigned int)mLines.size());
 	}
 }
 
@@ -128,7 +128,10 @@ void DateTimeComponent::update(int deltaTime)
 		{
 			mRelativeUpdateAccumulator = 0;
 			updateTextCache();
+			invalidate();
 		}
+
+		mWindow->scheduleUpdate(1000 - mRelativeUpdateAccumulator);
 	}
 
 	GuiComponent::update(deltaTime);
@@ -212,6 +212,7 @@ protected:
 		// update the title overlay opacity
 		const int dir = (mScrollTier >= mTierList.count - 1) ? 1 : -1; // fade in if scroll tier is >= 1, otherwise fade out
 		int op = mTitleOverlayOpacity + deltaTime*dir; // we just do a 1-to-1 time -> opacity, no scaling
+		const unsigned char prevOpacity = mTitleOverlayOpacity;
 		if(op >= 255)
 			mTitleOverlayOpacity = 255;
 		else if(op <= 0)
@@ -219,9 +220,14 @@ protected:
 		else
 			mTitleOverlayOpacity = (unsigned char)op;
 
+		if(mTitleOverlayOpacity != prevOpacity)
+			invalidate();
+
 		if(mScrollVelocity == 0 || size() < 2)
 			return;
 
+		invalidate();
+
 		mScrollCursorAccumulator += deltaTime;
 		mScrollTierAccumulator += deltaTime;
 
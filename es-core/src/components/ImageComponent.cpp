@@ -252,28 +252,7 @@ void ImageComponent::render(const Eigen::Affine3f& parentTrans)
 		if(mTexture->isInitialized())
 		{
 			// actually draw the image
-			mTexture->bind();
-
-			glEnable(GL_TEXTURE_2D);
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-			glEnableClientState(GL_VERTEX_ARRAY);
-			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-			glEnableClientState(GL_COLOR_ARRAY);
-
-			glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].pos);
-			glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].tex);
-			glColorPointer(4, GL_UNSIGNED_BYTE, 0, mColors);
-
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-
-			glDisableClientState(GL_VERTEX_ARRAY);
-			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-			glDisableClientState(GL_COLOR_ARRAY);
-
-			glDisable(GL_TEXTURE_2D);
-			glDisable(GL_BLEND);
+			Renderer::drawTriangles(mTexture->getTextureId(), mVertices[0].pos.data(), mColors, 6);
 		}else{
 			LOG(LogError) << "Image texture is not initialized!";
 			mTexture.reset();
@@ -290,6 +269,19 @@ bool ImageComponent::hasImage()
 
 void ImageComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties)
 {
+	// looked up once, this runs for every element of every view
+	static const ThemeData::PropertyInfo* posProp = ThemeData::getPropertyInfo("pos");
+	static const ThemeData::PropertyInfo* sizeProp = ThemeData::getPropertyInfo("size");
+	static const ThemeData::PropertyInfo* maxSizeProp = ThemeData::getPropertyInfo("maxSize");
+	static const ThemeData::PropertyInfo* originProp = ThemeData::getPropertyInfo("origin");
+	static const ThemeData::PropertyInfo* defaultProp = ThemeData::getPropertyInfo("default");
+	static const ThemeData::PropertyInfo* pathProp = ThemeData::getPropertyInfo("path");
+	static const ThemeData::PropertyInfo* tileProp = ThemeData::getPropertyInfo("tile");
+	static const ThemeData::PropertyInfo* colorProp = ThemeData::getPropertyInfo("color");
+	static const ThemeData::PropertyInfo* rotationProp = ThemeData::getPropertyInfo("rotation");
+	static const ThemeData::PropertyInfo* rotationOriginProp = ThemeData::getPropertyInfo("rotationOrigin");
+	static const ThemeData::PropertyInfo* zIndexProp = ThemeData::getPropertyInfo("zIndex");
+
 	using namespace ThemeFlags;
 
 	const ThemeData::ThemeElement* elem = theme->getElement(view, element, "image");
@@ -300,46 +292,46 @@ void ImageComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const s
 
 	Eigen::Vector2f scale = getParent() ? getParent()->getSize() : Eigen::Vector2f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 
-	if(properties & POSITION && elem->has("pos"))
+	if(properties & POSITION && elem->has(posProp))
 	{
-		Eigen::Vector2f denormalized = elem->get<Eigen::Vector2f>("pos").cwiseProduct(scale);
+		Eigen::Vector2f denormalized = elem->get<Eigen::Vector2f>(posProp).cwiseProduct(scale);
 		setPosition(Eigen::Vector3f(denormalized.x(), denormalized.y(), 0));
 	}
 
 	if(properties & ThemeFlags::SIZE)
 	{
-		if(elem->has("size"))
-			setResize(elem->get<Eigen::Vector2f>("size").cwiseProduct(scale));
-		else if(elem->has("maxSize"))
-			setMaxSize(elem->get<Eigen::Vector2f>("maxSize").cwiseProduct(scale));
+		if(elem->has(sizeProp))
+			setResize(elem->get<Eigen::Vector2f>(sizeProp).cwiseProduct(scale));
+		else if(elem->has(maxSizeProp))
+			setMaxSize(elem->get<Eigen::Vector2f>(maxSizeProp).cwiseProduct(scale));
 	}
 
 	// position + size also implies origin
-	if((properties & ORIGIN || (properties & POSITION && properties & ThemeFlags::SIZE)) && elem->has("origin"))
-		setOrigin(elem->get<Eigen::Vector2f>("origin"));
+	if((properties & ORIGIN || (properties & POSITION && properties & ThemeFlags::SIZE)) && elem->has(originProp))
+		setOrigin(elem->get<Eigen::Vector2f>(originProp));
 
-	if(elem->has("default")) {
-		setDefaultImage(elem->get<std::string>("default"));
+	if(elem->has(defaultProp)) {
+		setDefaultImage(elem->get<std::string>(defaultProp));
 	}
 
-	if(properties & PATH && elem->has("path"))
+	if(properties & PATH && elem->has(pathProp))
 	{
-		bool tile = (elem->has("tile") && elem->get<bool>("tile"));
-		setImage(elem->get<std::string>("path"), tile);
+		bool tile = (elem->has(tileProp) && elem->get<bool>(tileProp));
+		setImage(elem->get<std::string>(pathProp), tile);
 	}
 
-	if(properties & COLOR && elem->has("color"))
-		setColorShift(elem->get<unsigned int>("color"));
+	if(properties & COLOR && elem->has(colorProp))
+		setColorShift(elem->get<unsigned int>(colorProp));
 
 	if(properties & ThemeFlags::ROTATION) {
-		if(elem->has("rotation"))
-			setRotationDegrees(elem->get<float>("rotation"));
-		if(elem->has("rotationOrigin"))
-			setRotationOrigin(elem->get<Eigen::Vector2f>("rotationOrigin"));
+		if(elem->has(rotationProp))
+			setRotationDegrees(elem->get<float>(rotationProp));
+		if(elem->has(rotationOriginProp))
+			setRotationOrigin(elem->get<Eigen::Vector2f>(rotationOriginProp));
 	}
 
-	if(properties & ThemeFlags::Z_INDEX && elem->has("zIndex"))
-		setZIndex(elem->get<float>("zIndex"));
+	if(properties & ThemeFlags::Z_INDEX && elem->has(zIndexProp))
+		setZIndex(elem->get<float>(zIndexProp));
 	else
 		setZIndex(getDefaultZIndex());
 }
@@ -1,6 +1,7 @@
 #include "components/ScrollableContainer.h"
 #include "Renderer.h"
 #include "Log.h"
+#include "Window.h"
 
 #define AUTO_SCROLL_RESET_DELAY 10000 // ms to reset to top after we reach the bottom
 #define AUTO_SCROLL_DELAY 8000 // ms to wait before we start to scroll
@@ -68,7 +69,10 @@ void ScrollableContainer::update(int deltaTime)
 		{
 			mScrollPos += mScrollDir;
 			mAutoScrollAccumulator -= mAutoScrollSpeed;
+			invalidate();
 		}
+
+		mWindow->scheduleUpdate(mAutoScrollSpeed - mAutoScrollAccumulator);
 	}
 
 	//clip scrolling within bounds
@@ -98,6 +102,8 @@ void ScrollableContainer::update(int deltaTime)
 		mAutoScrollResetAccumulator += deltaTime;
 		if(mAutoScrollResetAccumulator >= AUTO_SCROLL_RESET_DELAY)
 			reset();
+		else
+			mWindow->scheduleUpdate(AUTO_SCROLL_RESET_DELAY - mAutoScrollResetAccumulator);
 	}
 
 	GuiComponent::update(deltaTime);
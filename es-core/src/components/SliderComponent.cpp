@@ -3,6 +3,7 @@
 #include "Renderer.h"
 #include "resources/Font.h"
 #include "Log.h"
+#include "Window.h"
 #include "Util.h"
 
 #define MOVE_REPEAT_DELAY 500
@@ -55,7 +56,10 @@ void SliderComponent::update(int deltaTime)
 		{
 			setValue(mValue + mMoveRate);
 			mMoveAccumulator -= MOVE_REPEAT_RATE;
+			invalidate();
 		}
+
+		mWindow->scheduleUpdate(MOVE_REPEAT_RATE - mMoveAccumulator);
 	}
 	
 	GuiComponent::update(deltaTime);
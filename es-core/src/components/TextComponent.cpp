@@ -249,6 +249,14 @@ std::string TextComponent::getValue() const
 
 void TextComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties)
 {
+	// looked up once, this runs for every element of every view
+	static const ThemeData::PropertyInfo* colorProp = ThemeData::getPropertyInfo("color");
+	static const ThemeData::PropertyInfo* backgroundColorProp = ThemeData::getPropertyInfo("backgroundColor");
+	static const ThemeData::PropertyInfo* alignmentProp = ThemeData::getPropertyInfo("alignment");
+	static const ThemeData::PropertyInfo* textProp = ThemeData::getPropertyInfo("text");
+	static const ThemeData::PropertyInfo* forceUppercaseProp = ThemeData::getPropertyInfo("forceUppercase");
+	static const ThemeData::PropertyInfo* lineSpacingProp = ThemeData::getPropertyInfo("lineSpacing");
+
 	GuiComponent::applyTheme(theme, view, element, properties);
 
 	using namespace ThemeFlags;
@@ -257,18 +265,18 @@ void TextComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const st
 	if(!elem)
 		return;
 
-	if (properties & COLOR && elem->has("color"))
-		setColor(elem->get<unsigned int>("color"));
+	if (properties & COLOR && elem->has(colorProp))
+		setColor(elem->get<unsigned int>(colorProp));
 
 	setRenderBackground(false);
-	if (properties & COLOR && elem->has("backgroundColor")) {
-		setBackgroundColor(elem->get<unsigned int>("backgroundColor"));
+	if (properties & COLOR && elem->has(backgroundColorProp)) {
+		setBackgroundColor(elem->get<unsigned int>(backgroundColorProp));
 		setRenderBackground(true);
 	}
 
-	if(properties & ALIGNMENT && elem->has("alignment"))
+	if(properties & ALIGNMENT && elem->has(alignmentProp))
 	{
-		std::string str = elem->get<std::string>("alignment");
+		std::string str = elem->get<std::string>(alignmentProp);
 		if(str == "left")
 			setHorizontalAlignment(ALIGN_LEFT);
 		else if(str == "center")
@@ -279,14 +287,14 @@ void TextComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const st
 			LOG(LogError) << "Unknown text alignment string: " << str;
 	}
 
-	if(properties & TEXT && elem->has("text"))
-		setText(elem->get<std::string>("text"));
+	if(properties & TEXT && elem->has(textProp))
+		setText(elem->get<std::string>(textProp));
 
-	if(properties & FORCE_UPPERCASE && elem->has("forceUppercase"))
-		setUppercase(elem->get<bool>("forceUppercase"));
+	if(properties & FORCE_UPPERCASE && elem->has(forceUppercaseProp))
+		setUppercase(elem->get<bool>(forceUppercaseProp));
 
-	if(properties & LINE_SPACING && elem->has("lineSpacing"))
-		setLineSpacing(elem->get<float>("lineSpacing"));
+	if(properties & LINE_SPACING && elem->has(lineSpacingProp))
+		setLineSpacing(elem->get<float>(lineSpacingProp));
 
 	setFont(Font::getFromTheme(elem, properties, mFont));
 }
@@ -185,9 +185,12 @@ void TextEditComponent::updateCursorRepeat(int deltaTime)
 	mCursorRepeatTimer += deltaTime;
 	while(mCursorRepeatTimer >= CURSOR_REPEAT_SPEED)
 	{
+		invalidate();
 		moveCursor(mCursorRepeatDir);
 		mCursorRepeatTimer -= CURSOR_REPEAT_SPEED;
 	}
+
+	mWindow->scheduleUpdate(CURSOR_REPEAT_SPEED - mCursorRepeatTimer);
 }
 
 void TextEditComponent::moveCursor(int amt)
@@ -320,6 +320,7 @@ void GuiInputConfig::update(int deltaTime)
 {
 	if(mConfiguringRow && mHoldingInput && inputSkippable[mHeldInputId])
 	{
+		invalidate();
 		int prevSec = mHeldTime / 1000;
 		mHeldTime += deltaTime;
 		int curSec = mHeldTime / 1000;
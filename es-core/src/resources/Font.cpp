@@ -6,6 +6,7 @@
 #include "Renderer.h"
 #include "Log.h"
 #include "Util.h"
+#include "Profiler.h"
 
 FT_Library Font::sLibrary = NULL;
 
@@ -255,26 +256,14 @@ void Font::FontTexture::initTexture()
 {
 	assert(textureId == 0);
 
-	glGenTextures(1, &textureId);
-	glBindTexture(GL_TEXTURE_2D, textureId);
-
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-
-	glPixelStorei(GL_PACK_ALIGNMENT, 1);
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, textureSize.x(), textureSize.y(), 0, GL_ALPHA, GL_UNSIGNED_BYTE, NULL);
+	textureId = Renderer::createTexture(GL_ALPHA, GL_NEAREST, false, textureSize.x(), textureSize.y(), NULL);
 }
 
 void Font::FontTexture::deinitTexture()
 {
 	if(textureId != 0)
 	{
-		glDeleteTextures(1, &textureId);
+		Renderer::destroyTexture(textureId);
 		textureId = 0;
 	}
 }
@@ -438,9 +427,8 @@ Font::Glyph* Font::getGlyph(unsigned int id)
 	glyph.bearing << (float)g->metrics.horiBearingX / 64.0f, (float)g->metrics.horiBearingY / 64.0f;
 
 	// upload glyph bitmap to texture
-	glBindTexture(GL_TEXTURE_2D, tex->textureId);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, g->bitmap.buffer);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	Profiler::Scope scope("Font::uploadGlyph", "texture");
+	Renderer::updateTexture(tex->textureId, GL_ALPHA, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), g->bitmap.buffer);
 
 	// update max glyph height
 	if(glyphSize.y() > mMaxGlyphHeight)
@@ -475,11 +463,8 @@ void Font::rebuildTextures()
 		Eigen::Vector2i glyphSize((int)(it->second.texSize.x() * tex->textureSize.x()), (int)(it->second.texSize.y() * tex->textureSize.y()));
 
 		// upload to texture
-		glBindTexture(GL_TEXTURE_2D, tex->textureId);
-		glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, glyphSlot->bitmap.buffer);
+		Renderer::updateTexture(tex->textureId, GL_ALPHA, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), glyphSlot->bitmap.buffer);
 	}
-
-	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Font::renderTextCache(TextCache* cache)
@@ -494,29 +479,7 @@ void Font::renderTextCache(TextCache* cache)
 	{
 		assert(*it->textureIdPtr != 0);
 
-		auto vertexList = *it;
-
-		glBindTexture(GL_TEXTURE_2D, *it->textureIdPtr);
-		glEnable(GL_TEXTURE_2D);
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(2, GL_FLOAT, sizeof(TextCache::Vertex), it->verts[0].pos.data());
-		glTexCoordPointer(2, GL_FLOAT, sizeof(TextCache::Vertex), it->verts[0].tex.data());
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, it->colors.data());
-
-		glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(it->verts.size()));
-
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
-
-		glDisable(GL_TEXTURE_2D);
-		glDisable(GL_BLEND);
+		Renderer::drawTriangles(*it->textureIdPtr, it->verts[0].pos.data(), it->colors.data(), (unsigned int)it->verts.size());
 	}
 }
 
@@ -566,79 +529,147 @@ float Font::getLetterHeight()
 	return glyph->texSize.y() * glyph->texture->textureSize.y();
 }
 
-//the worst algorithm ever written
-//breaks up a normal string with newlines to make it fit xLen
-std::string Font::wrapText(std::string text, float xLen)
+// finds the offsets in text where a new line has to be started to make it fit xLen
+// words are measured glyph by glyph in a single pass; a word that doesn't fit on the current line
+// (including its trailing whitespace) is moved to the next one, words wider than xLen get a line of their own
+std::vector<size_t> Font::getWrapBreaks(const std::string& text, float xLen)
 {
-	std::string out;
+	Profiler::Scope scope("Font::getWrapBreaks", "text");
 
-	std::string line, word, temp;
-	size_t space;
+	std::vector<size_t> breaks;
 
-	Eigen::Vector2f textSize;
+	float lineWidth = 0.0f; // width of all complete words on the current line
+	float wordWidth = 0.0f; // width of the word currently being measured
+	size_t lineStart = 0;
+	size_t wordStart = 0;
 
-	while(text.length() > 0) //while there's text or we still have text to render
+	size_t cursor = 0;
+	while(cursor < text.length())
 	{
-		space = text.find_first_of(" \t\n");
-		if(space == std::string::npos)
-			space = text.length() - 1;
+		unsigned int character = readUnicodeChar(text, cursor); // advances cursor
 
-		word = text.substr(0, space + 1);
-		text.erase(0, space + 1);
+		if(character != '\n')
+		{
+			Glyph* glyph = getGlyph(character);
+			if(glyph)
+				wordWidth += glyph->advance.x();
+		}
 
-		temp = line + word;
+		// a word ends after whitespace or at the end of the text
+		if(character != ' ' && character != '\t' && character != '\n' && cursor < text.length())
+			continue;
+
+		if(lineWidth + wordWidth > xLen && wordStart != lineStart)
+		{
+			// the word won't fit, so break here
+			breaks.push_back(wordStart);
+			lineStart = wordStart;
+			lineWidth = 0.0f;
+		}
 
-		textSize = sizeText(temp);
+		lineWidth += wordWidth;
+		wordWidth = 0.0f;
+		wordStart = cursor;
 
-		// if the word will fit on the line, add it to our line, and continue
-		if(textSize.x() <= xLen)
+		if(character == '\n')
 		{
-			line = temp;
-			continue;
-		}else{
-			// the next word won't fit, so break here
-			out += line + '\n';
-			line = word;
+			lineWidth = 0.0f;
+			lineStart = cursor;
 		}
 	}
 
-	// whatever's left should fit
-	out += line;
+	return breaks;
+}
+
+//breaks up a normal string with newlines to make it fit xLen
+std::string Font::wrapText(std::string text, float xLen)
+{
+	const std::vector<size_t> breaks = getWrapBreaks(text, xLen);
+
+	std::string out;
+	out.reserve(text.length() + breaks.size());
+
+	size_t start = 0;
+	for(auto it = breaks.cbegin(); it != breaks.cend(); it++)
+	{
+		out.append(text, start, *it - start);
+		out += '\n';
+		start = *it;
+	}
+	out.append(text, start, std::string::npos);
 
 	return out;
 }
 
 Eigen::Vector2f Font::sizeWrappedText(std::string text, float xLen, float lineSpacing)
 {
-	text = wrapText(text, xLen);
-	return sizeText(text, lineSpacing);
+	const std::vector<size_t> breaks = getWrapBreaks(text, xLen);
+	auto nextBreak = breaks.cbegin();
+
+	float lineWidth = 0.0f;
+	float highestWidth = 0.0f;
+
+	const float lineHeight = getHeight(lineSpacing);
+
+	float y = lineHeight;
+
+	size_t i = 0;
+	while(i < text.length())
+	{
+		if(nextBreak != breaks.cend() && *nextBreak == i)
+		{
+			if(lineWidth > highestWidth)
+				highestWidth = lineWidth;
+
+			lineWidth = 0.0f;
+			y += lineHeight;
+			nextBreak++;
+		}
+
+		unsigned int character = readUnicodeChar(text, i); // advances i
+
+		if(character == '\n')
+		{
+			if(lineWidth > highestWidth)
+				highestWidth = lineWidth;
+
+			lineWidth = 0.0f;
+			y += lineHeight;
+			continue;
+		}
+
+		Glyph* glyph = getGlyph(character);
+		if(glyph)
+			lineWidth += glyph->advance.x();
+	}
+
+	if(lineWidth > highestWidth)
+		highestWidth = lineWidth;
+
+	return Eigen::Vector2f(highestWidth, y);
 }
 
 Eigen::Vector2f Font::getWrappedTextCursorOffset(std::string text, float xLen, size_t stop, float lineSpacing)
 {
-	std::string wrappedText = wrapText(text, xLen);
+	const std::vector<size_t> breaks = getWrapBreaks(text, xLen);
+	auto nextBreak = breaks.cbegin();
 
 	float lineWidth = 0.0f;
 	float y = 0.0f;
 
-	size_t wrapCursor = 0;
 	size_t cursor = 0;
 	while(cursor < stop)
 	{
-		unsigned int wrappedCharacter = readUnicodeChar(wrappedText, wrapCursor);
-		unsigned int character = readUnicodeChar(text, cursor);
-
-		if(wrappedCharacter == '\n' && character != '\n')
+		if(nextBreak != breaks.cend() && *nextBreak == cursor)
 		{
-			//this is where the wordwrap inserted a newline
-			//reset lineWidth and increment y, but don't consume a cursor character
+			//this is where the wordwrap starts a new line
 			lineWidth = 0.0f;
 			y += getHeight(lineSpacing);
-
-			cursor = getPrevCursor(text, cursor); // unconsume
-			continue;
+			nextBreak++;
 		}
 
+		unsigned int character = readUnicodeChar(text, cursor);
+
 		if(character == '\n')
 		{
 			lineWidth = 0.0f;
@@ -686,6 +717,8 @@ inline float font_round(float v)
 
 TextCache* Font::buildTextCache(const std::string& text, Eigen::Vector2f offset, unsigned int color, float xLen, Alignment alignment, float lineSpacing)
 {
+	Profiler::Scope scope("Font::buildTextCache", "text");
+
 	float x = offset[0] + (xLen != 0 ? getNewlineStartOffset(text, 0, xLen, alignment) : 0);
 
 	float yTop = getGlyph('S')->bearing.y();
@@ -3,6 +3,7 @@
 #define ES_CORE_RESOURCES_FONT_H
 
 #include <string>
+#include <vector>
 #include "platform.h"
 #include GLHEADER
 #include <ft2build.h>
@@ -46,6 +47,7 @@ public:
 	TextCache* buildTextCache(const std::string& text, Eigen::Vector2f offset, unsigned int color, float xLen, Alignment alignment = ALIGN_LEFT, float lineSpacing = 1.5f);
 	void renderTextCache(TextCache* cache);
 
+	std::vector<size_t> getWrapBreaks(const std::string& text, float xLen); // Returns the offsets in text where wrapping starts a new line.
 	std::string wrapText(std::string text, float xLen); // Inserts newlines into text to make it wrap properly.
 	Eigen::Vector2f sizeWrappedText(std::string text, float xLen, float lineSpacing = 1.5f); // Returns the expected size of a string after wrapping is applied.
 	Eigen::Vector2f getWrappedTextCursorOffset(std::string text, float xLen, size_t cursor, float lineSpacing = 1.5f); // Returns the position of of the cursor after moving "cursor" characters.
@@ -80,7 +82,7 @@ private:
 
 	struct FontTexture
 	{
-		GLuint textureId;
+		unsigned int textureId; // Renderer texture handle
 		Eigen::Vector2i textureSize;
 
 		Eigen::Vector2i writePos;
@@ -155,7 +157,7 @@ protected:
 
 	struct VertexList
 	{
-		GLuint* textureIdPtr; // this is a pointer because the texture ID can change during deinit/reinit (when launching a game)
+		unsigned int* textureIdPtr; // this is a pointer because the texture ID can change during deinit/reinit (when launching a game)
 		std::vector<Vertex> verts;
 		std::vector<GLubyte> colors;
 	};
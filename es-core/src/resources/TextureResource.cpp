@@ -5,6 +5,7 @@
 #include "ImageIO.h"
 #include "Renderer.h"
 #include "Util.h"
+#include "Profiler.h"
 #include "resources/SVGResource.h"
 
 std::map< TextureResource::TextureKeyType, std::weak_ptr<TextureResource> > TextureResource::sTextureMap;
@@ -40,24 +41,18 @@ void TextureResource::initFromPixels(const unsigned char* dataRGBA, size_t width
 
 	assert(width > 0 && height > 0);
 
-	//now for the openGL texture stuff
-	glGenTextures(1, &mTextureID);
-	glBindTexture(GL_TEXTURE_2D, mTextureID);
-
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, dataRGBA);
+	Profiler::Scope scope("TextureResource::upload", "texture");
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-	const GLint wrapMode = mTile ? GL_REPEAT : GL_CLAMP_TO_EDGE;
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
+	//now for the openGL texture stuff
+	mTextureID = Renderer::createTexture(GL_RGBA, GL_LINEAR, mTile, width, height, dataRGBA);
 
 	mTextureSize << width, height;
 }
 
 void TextureResource::initFromMemory(const char* data, size_t length)
 {
+	Profiler::Scope scope("TextureResource::decode", "texture");
+
 	size_t width, height;
 	std::vector<unsigned char> imageRGBA = ImageIO::loadFromMemoryRGBA32((const unsigned char*)(data), length, width, height);
 
@@ -74,7 +69,7 @@ void TextureResource::deinit()
 {
 	if(mTextureID != 0)
 	{
-		glDeleteTextures(1, &mTextureID);
+		Renderer::destroyTexture(mTextureID);
 		mTextureID = 0;
 	}
 }
@@ -89,12 +84,12 @@ bool TextureResource::isTiled() const
 	return mTile;
 }
 
-void TextureResource::bind() const
+unsigned int TextureResource::getTextureId() const
 {
-	if(mTextureID != 0)
-		glBindTexture(GL_TEXTURE_2D, mTextureID);
-	else
-		LOG(LogError) << "Tried to bind uninitialized texture!";
+	if(mTextureID == 0)
+		LOG(LogError) << "Tried to draw uninitialized texture!";
+
+	return mTextureID;
 }
 
 
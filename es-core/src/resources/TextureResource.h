@@ -24,7 +24,7 @@ public:
 	bool isInitialized() const;
 	bool isTiled() const;
 	const Eigen::Vector2i& getSize() const;
-	void bind() const;
+	unsigned int getTextureId() const; // the Renderer's handle for this texture, for Renderer::drawTriangles()
 	
 	// Warning: will NOT correctly reinitialize when this texture is reloaded (e.g. ES starts/stops playing a game).
 	virtual void initFromMemory(const char* file, size_t length);
@@ -44,7 +44,7 @@ protected:
 	const bool mTile;
 
 private:
-	GLuint mTextureID;
+	unsigned int mTextureID;
 
 	typedef std::pair<std::string, bool> TextureKeyType;
 	static std::map< TextureKeyType, std::weak_ptr<TextureResource> > sTextureMap; // map of textures, used to prevent duplicate textures